@@ -0,0 +1,155 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_BATCHER_HPP
+#define CATCH2TESTEXAMPLE_BATCHER_HPP
+
+#include "scheduler.hpp"
+#include "task.hpp"
+#include "timer.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Coalesces concurrent co_await batcher.submit(req) calls into one call of the batch function.
+// A batch is sent when max_batch requests are waiting, or when the window since the first
+// waiting request has passed. Each waiter resumes with the response at its own position.
+//
+// Scheduler timers have millisecond resolution, so windows below one millisecond flush as soon
+// as the coroutines that are already ready have run, i.e. everything submitted in the same pass.
+template<typename Req, typename Resp, typename Sched = Scheduler>
+class Batcher {
+public:
+    using BatchFn = std::function<Task<std::vector<Resp>>(std::vector<Req>)>;
+
+    struct Options {
+        std::size_t max_batch = 64;
+        std::chrono::microseconds window{200};
+    };
+
+    explicit Batcher(BatchFn fn, Options options = {}, Sched& scheduler = get_scheduler())
+        : fn(std::move(fn)), options(options), scheduler(scheduler) {}
+
+    Batcher(const Batcher&) = delete;
+    Batcher& operator=(const Batcher&) = delete;
+
+    class SubmitAwaitable {
+    public:
+        SubmitAwaitable(Batcher& batcher, Req request) : batcher(batcher), request(std::move(request)) {}
+
+        bool await_ready() { return false; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> awaiting) {
+            coro = awaiting;
+            priority = priority_of(awaiting);
+            batcher.enqueue(this);
+        }
+
+        Resp await_resume() {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+            return std::move(*response);
+        }
+
+    private:
+        friend class Batcher;
+
+        Batcher& batcher;
+        Req request;
+        std::optional<Resp> response;
+        std::exception_ptr exception;
+        std::coroutine_handle<> coro;
+        Priority priority = Priority::Normal;
+    };
+
+    SubmitAwaitable submit(Req request) {
+        return SubmitAwaitable{*this, std::move(request)};
+    }
+
+    // Number of batches sent so far
+    std::size_t batches() const { return batch_count; }
+
+private:
+    void enqueue(SubmitAwaitable* waiter) {
+        pending.push_back(waiter);
+        if (pending.size() >= options.max_batch) {
+            flush();
+        } else if (pending.size() == 1) {
+            scheduler.spawn(flush_after_window(generation));
+        }
+    }
+
+    Task<void> flush_after_window(std::size_t batch) {
+        const auto window = std::chrono::ceil<std::chrono::milliseconds>(options.window);
+        if (options.window < std::chrono::milliseconds(1)) {
+            co_await reschedule(scheduler);
+        } else {
+            co_await BasicSleepAwaitable<Sched>{scheduler, window};
+        }
+        // The batch may already have gone out because it filled up
+        if (batch == generation) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (pending.empty()) {
+            return;
+        }
+        ++generation;
+        ++batch_count;
+
+        std::vector<SubmitAwaitable*> waiters;
+        waiters.swap(pending);
+        pending.reserve(options.max_batch);
+        scheduler.spawn(run_batch(std::move(waiters)));
+    }
+
+    Task<void> run_batch(std::vector<SubmitAwaitable*> waiters) {
+        std::vector<Req> requests;
+        requests.reserve(waiters.size());
+        for (auto* waiter : waiters) {
+            requests.push_back(std::move(waiter->request));
+        }
+
+        std::exception_ptr exception;
+        try {
+            auto responses = co_await fn(std::move(requests));
+            if (responses.size() != waiters.size()) {
+                throw std::length_error("Batcher: batch function returned the wrong number of responses");
+            }
+            for (std::size_t i = 0; i < waiters.size(); ++i) {
+                waiters[i]->response.emplace(std::move(responses[i]));
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        for (auto* waiter : waiters) {
+            if (exception) {
+                waiter->exception = exception;
+            }
+            scheduler.post(waiter->coro, waiter->priority);
+        }
+    }
+
+    BatchFn fn;
+    Options options;
+    Sched& scheduler;
+    std::vector<SubmitAwaitable*> pending;
+    std::size_t generation = 0;
+    std::size_t batch_count = 0;
+};
+
+
+#endif //CATCH2TESTEXAMPLE_BATCHER_HPP
@@ -0,0 +1,433 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to generate a main() function
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <execution>
+#include <numeric>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <unistd.h>
+#include <vector>
+
+#include "io.hpp"
+#include "ipc_channel.hpp"
+#include "parallel.hpp"
+#include "ready_task.hpp"
+#include "timer.hpp"
+#include "uring_backend.hpp"
+#include "utils.hpp"
+
+// Comparative benchmarks; run with e.g. `bench_main "[backend]"`
+
+namespace {
+    constexpr std::size_t file_size = 4 * 1024 * 1024;
+    constexpr std::size_t block_size = 4096;
+
+    int make_test_file() {
+        char path[] = "/tmp/lazync_bench_XXXXXX";
+        int fd = mkstemp(path);
+        unlink(path);
+        std::vector<char> data(file_size, 'x');
+        [[maybe_unused]] auto res = write(fd, data.data(), data.size());
+        return fd;
+    }
+
+    template<typename Sched>
+    Task<void> read_blocks(Sched* scheduler, int fd, std::size_t first, std::size_t count, std::size_t* total) {
+        std::array<std::byte, block_size> buffer;
+        for (std::size_t i = first; i < first + count; ++i) {
+            *total += co_await async_read(*scheduler, fd, std::span(buffer), static_cast<std::int64_t>(i * block_size));
+        }
+    }
+
+    template<typename Sched>
+    Task<void> ping_pong(Sched* scheduler, int fd, int peer, std::size_t rounds) {
+        std::array<std::byte, 64> buffer{};
+        for (std::size_t i = 0; i < rounds; ++i) {
+            co_await async_write(*scheduler, fd, std::span<const std::byte>(buffer));
+            co_await async_read(*scheduler, peer, std::span(buffer));
+        }
+    }
+
+    template<typename Backend>
+    void backend_benchmarks(const char* name) {
+        using Sched = BasicScheduler<Backend>;
+        Sched scheduler;
+        const std::string prefix = std::string(name) + ": ";
+
+        BENCHMARK(prefix + "64 concurrent 1ms timers") {
+            for (int i = 0; i < 64; ++i) {
+                scheduler.spawn(sleep_ms(scheduler, 1));
+            }
+            scheduler.run();
+        };
+
+        int fd = make_test_file();
+        constexpr std::size_t blocks = file_size / block_size;
+
+        BENCHMARK(prefix + "sequential 4KiB reads of a 4MiB file") {
+            std::size_t total = 0;
+            scheduler.schedule(read_blocks(&scheduler, fd, 0, blocks, &total));
+            return total;
+        };
+
+        BENCHMARK(prefix + "4KiB reads of a 4MiB file, 16 in flight") {
+            std::size_t total = 0;
+            constexpr std::size_t per_reader = blocks / 16;
+            for (std::size_t r = 0; r < 16; ++r) {
+                scheduler.spawn(read_blocks(&scheduler, fd, r * per_reader, per_reader, &total));
+            }
+            scheduler.run();
+            return total;
+        };
+        close(fd);
+
+        int sockets[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+        BENCHMARK(prefix + "1000 socket round trips") {
+            scheduler.schedule(ping_pong(&scheduler, sockets[0], sockets[1], 1000));
+        };
+        close(sockets[0]);
+        close(sockets[1]);
+
+        BENCHMARK(prefix + "1000 cross-thread wakeup round trips") {
+            struct Context {
+                Sched* scheduler;
+                std::atomic<int> received{0};
+            } context{&scheduler};
+            typename Sched::Wakeup wakeup;
+            scheduler.init_wakeup(wakeup, [](typename Sched::Wakeup& w) {
+                auto* ctx = static_cast<Context*>(w.data);
+                if (ctx->received.fetch_add(1, std::memory_order_release) + 1 == 1000) {
+                    ctx->scheduler->close_wakeup(w);
+                }
+            }, &context);
+
+            // Every send is acknowledged before the next one, so none are coalesced
+            std::thread sender([&] {
+                for (int i = 0; i < 1000; ++i) {
+                    Sched::send(wakeup);
+                    while (context.received.load(std::memory_order_acquire) <= i) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            scheduler.run();
+            sender.join();
+            return context.received.load();
+        };
+    }
+}
+
+namespace {
+    Task<int> leaf(int value) {
+        co_return value;
+    }
+
+    template<std::size_t... I>
+    Task<int> fan_out(std::index_sequence<I...>) {
+        auto results = co_await when_all(leaf(static_cast<int>(I))...);
+        co_return std::apply([](auto... v) { return (v + ...); }, results);
+    }
+
+    template<std::size_t... I>
+    Task<int> fan_out_local(std::index_sequence<I...>) {
+        auto results = co_await when_all_local(leaf(static_cast<int>(I))...);
+        co_return std::apply([](auto... v) { return (v + ...); }, results);
+    }
+
+    // The leaves complete synchronously, so resuming the root once runs the whole fan-out
+    int run_inline(Task<int> task) {
+        task.get_handle().resume();
+        return task.get_handle().promise().value;
+    }
+
+    template<std::size_t N>
+    void fan_out_benchmarks() {
+        const std::string ways = std::to_string(N) + "-way";
+        BENCHMARK("when_all, " + ways) {
+            return run_inline(fan_out(std::make_index_sequence<N>{}));
+        };
+        BENCHMARK("when_all_local, " + ways) {
+            return run_inline(fan_out_local(std::make_index_sequence<N>{}));
+        };
+    }
+}
+
+namespace {
+    std::vector<int> cache(1024, 1);
+
+    Task<int> cached_lazy(std::size_t key) {
+        co_return cache[key];
+    }
+
+    EagerTask<int> cached_eager(std::size_t key) {
+        co_return cache[key];
+    }
+
+    ValueOrTask<int> cached_ready(std::size_t key) {
+        return make_ready_task(cache[key]);
+    }
+
+    template<typename F>
+    Task<int> sum_hits(F lookup) {
+        int sum = 0;
+        for (std::size_t key = 0; key < cache.size(); ++key) {
+            sum += co_await lookup(key);
+        }
+        co_return sum;
+    }
+}
+
+namespace {
+    struct BenchMessage {
+        std::uint64_t sequence;
+        std::array<std::byte, 56> payload;
+    };
+
+    constexpr std::uint64_t stream_messages = 100000;
+    constexpr std::uint64_t round_trips = 1000;
+
+    // Resumes once fd is readable; the socket side of the comparison waits through uv_poll too
+    struct FdReadable {
+        UvScheduler& scheduler;
+        uv_poll_t& poll;
+        std::coroutine_handle<> waiter;
+
+        bool await_ready() { return false; }
+
+        void await_suspend(std::coroutine_handle<> coro) {
+            waiter = coro;
+            poll.data = this;
+            uv_poll_start(&poll, UV_READABLE, [](uv_poll_t* handle, int, int) {
+                auto* self = static_cast<FdReadable*>(handle->data);
+                uv_poll_stop(handle);
+                self->scheduler.post(self->waiter);
+            });
+        }
+
+        void await_resume() {}
+    };
+
+    // Reads exactly length bytes from a non-blocking socket
+    Task<void> read_exactly(UvScheduler* scheduler, uv_poll_t* poll, int fd, std::byte* buffer, std::size_t length) {
+        while (length > 0) {
+            const auto n = read(fd, buffer, length);
+            if (n > 0) {
+                buffer += n;
+                length -= static_cast<std::size_t>(n);
+            } else {
+                co_await FdReadable{*scheduler, *poll, {}};
+            }
+        }
+    }
+
+    Task<std::uint64_t> drain_channel(UvScheduler* scheduler, IpcChannel<BenchMessage, IpcProducers::Single>* channel) {
+        std::uint64_t received = 0;
+        std::uint64_t checksum = 0;
+        while (received < stream_messages) {
+            co_await channel->readable(*scheduler);
+            received += channel->drain([&checksum](const BenchMessage& message) { checksum += message.sequence; });
+        }
+        co_return checksum;
+    }
+
+    Task<std::uint64_t> drain_socket(UvScheduler* scheduler, uv_poll_t* poll, int fd) {
+        std::vector<BenchMessage> buffer(1024);
+        std::uint64_t received = 0;
+        std::uint64_t checksum = 0;
+        while (received < stream_messages) {
+            const auto batch = std::min<std::uint64_t>(buffer.size(), stream_messages - received);
+            co_await read_exactly(scheduler, poll, fd, reinterpret_cast<std::byte*>(buffer.data()),
+                                  batch * sizeof(BenchMessage));
+            for (std::uint64_t i = 0; i < batch; ++i) {
+                checksum += buffer[i].sequence;
+            }
+            received += batch;
+        }
+        co_return checksum;
+    }
+
+    using PingChannel = IpcChannel<BenchMessage, IpcProducers::Single>;
+
+    Task<void> echo_channel(UvScheduler* scheduler, PingChannel* in, PingChannel* out) {
+        for (;;) {
+            auto message = co_await in->receive(*scheduler);
+            while (!out->try_send(message)) {
+                std::this_thread::yield();
+            }
+            if (message.sequence == ~std::uint64_t{0}) {
+                co_return;
+            }
+        }
+    }
+
+    Task<void> ping_channel(UvScheduler* scheduler, PingChannel* out, PingChannel* in) {
+        BenchMessage message{};
+        for (std::uint64_t i = 0; i < round_trips; ++i) {
+            message.sequence = i;
+            out->try_send(message);
+            message = co_await in->receive(*scheduler);
+        }
+    }
+
+    Task<void> ping_socket(UvScheduler* scheduler, uv_poll_t* poll, int fd) {
+        BenchMessage message{};
+        for (std::uint64_t i = 0; i < round_trips; ++i) {
+            message.sequence = i;
+            [[maybe_unused]] auto n = write(fd, &message, sizeof(message));
+            co_await read_exactly(scheduler, poll, fd, reinterpret_cast<std::byte*>(&message), sizeof(message));
+        }
+    }
+
+    void close_poll(UvScheduler& scheduler, uv_poll_t& poll) {
+        uv_close(reinterpret_cast<uv_handle_t*>(&poll), nullptr);
+        scheduler.run();
+    }
+}
+
+TEST_CASE("Backend comparison: libuv", "[backend]") {
+    backend_benchmarks<UvBackend>("libuv");
+}
+
+TEST_CASE("Backend comparison: io_uring", "[backend]") {
+    backend_benchmarks<UringBackend>("io_uring");
+}
+
+TEST_CASE("when_all fan-out: shared state vs single-threaded", "[when_all]") {
+    fan_out_benchmarks<2>();
+    fan_out_benchmarks<8>();
+    fan_out_benchmarks<64>();
+}
+
+TEST_CASE("Cache hits: lazy Task vs EagerTask vs ValueOrTask", "[ready]") {
+    BENCHMARK("1024 hits, Task") {
+        return run_inline(sum_hits(cached_lazy));
+    };
+    BENCHMARK("1024 hits, EagerTask") {
+        return run_inline(sum_hits(cached_eager));
+    };
+    BENCHMARK("1024 hits, ValueOrTask") {
+        return run_inline(sum_hits(cached_ready));
+    };
+}
+
+TEST_CASE("Parallel algorithms vs std::execution::par", "[parallel]") {
+    std::vector<double> input(1 << 22);
+    std::iota(input.begin(), input.end(), 0.0);
+    auto f = [](double x) { return std::sqrt(x) * std::sin(x); };
+
+    BENCHMARK("async_transform") {
+        return get_scheduler().schedule(async_transform(input, f));
+    };
+
+    BENCHMARK("std::transform(par)") {
+        std::vector<double> output(input.size());
+        std::transform(std::execution::par, input.begin(), input.end(), output.begin(), f);
+        return output;
+    };
+
+    BENCHMARK("async_reduce") {
+        return get_scheduler().schedule(async_reduce(input, 0.0, std::plus<>{}));
+    };
+
+    BENCHMARK("std::reduce(par)") {
+        return std::reduce(std::execution::par, input.begin(), input.end(), 0.0);
+    };
+
+    BENCHMARK("async_for_each") {
+        std::vector<double> data = input;
+        get_scheduler().schedule(async_for_each(data, [&](double& x) { x = f(x); }));
+        return data;
+    };
+
+    BENCHMARK("std::for_each(par)") {
+        std::vector<double> data = input;
+        std::for_each(std::execution::par, data.begin(), data.end(), [&](double& x) { x = f(x); });
+        return data;
+    };
+}
+
+TEST_CASE("Shared-memory IpcChannel vs Unix domain socket", "[ipc]") {
+    UvScheduler scheduler;
+
+    BENCHMARK("IpcChannel, 100k 64-byte messages") {
+        auto channel = PingChannel::create(1024);
+        std::thread producer([&channel] {
+            for (std::uint64_t i = 0; i < stream_messages; ++i) {
+                while (!channel.try_send_with([i](BenchMessage& slot) { slot.sequence = i; })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        auto checksum = scheduler.schedule(drain_channel(&scheduler, &channel));
+        producer.join();
+        return checksum;
+    };
+
+    BENCHMARK("Unix socket, 100k 64-byte messages") {
+        int sockets[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+        fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+        uv_poll_t poll;
+        uv_poll_init(scheduler.get_loop(), &poll, sockets[0]);
+        std::thread producer([fd = sockets[1]] {
+            BenchMessage message{};
+            for (std::uint64_t i = 0; i < stream_messages; ++i) {
+                message.sequence = i;
+                [[maybe_unused]] auto n = write(fd, &message, sizeof(message));
+            }
+        });
+        auto checksum = scheduler.schedule(drain_socket(&scheduler, &poll, sockets[0]));
+        producer.join();
+        close_poll(scheduler, poll);
+        close(sockets[0]);
+        close(sockets[1]);
+        return checksum;
+    };
+
+    // Each side waits on its own loop, so every round trip includes two wakeups
+    {
+        auto to_echo = PingChannel::create(64);
+        auto from_echo = PingChannel::create(64);
+        std::thread echo([&to_echo, &from_echo] {
+            UvScheduler echo_scheduler;
+            echo_scheduler.schedule(echo_channel(&echo_scheduler, &to_echo, &from_echo));
+        });
+        BENCHMARK("IpcChannel, 1000 round trips") {
+            scheduler.schedule(ping_channel(&scheduler, &to_echo, &from_echo));
+        };
+        BenchMessage stop{};
+        stop.sequence = ~std::uint64_t{0};
+        to_echo.try_send(stop);
+        echo.join();
+    }
+
+    {
+        int sockets[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+        fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+        uv_poll_t poll;
+        uv_poll_init(scheduler.get_loop(), &poll, sockets[0]);
+        std::thread echo([fd = sockets[1]] {
+            BenchMessage message;
+            while (read(fd, &message, sizeof(message)) == static_cast<ssize_t>(sizeof(message))) {
+                [[maybe_unused]] auto n = write(fd, &message, sizeof(message));
+            }
+        });
+        BENCHMARK("Unix socket, 1000 round trips") {
+            scheduler.schedule(ping_socket(&scheduler, &poll, sockets[0]));
+        };
+        close_poll(scheduler, poll);
+        close(sockets[0]);
+        echo.join();
+        close(sockets[1]);
+    }
+}
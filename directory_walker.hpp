@@ -0,0 +1,313 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_DIRECTORY_WALKER_HPP
+#define CATCH2TESTEXAMPLE_DIRECTORY_WALKER_HPP
+
+#include "scheduler.hpp"
+#include "task.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <uv.h>
+
+// Entry types are bits so WalkOptions::types can select several
+enum class EntryType : std::uint8_t {
+    File = 1,
+    Directory = 2,
+    Symlink = 4,
+    Other = 8,
+};
+
+constexpr unsigned operator|(EntryType a, EntryType b) {
+    return static_cast<unsigned>(a) | static_cast<unsigned>(b);
+}
+
+constexpr unsigned operator|(unsigned a, EntryType b) {
+    return a | static_cast<unsigned>(b);
+}
+
+struct DirEntry {
+    std::string path;
+    EntryType type;
+};
+
+struct WalkOptions {
+    std::size_t max_in_flight = 64;   // scandir + stat requests outstanding at once
+    std::size_t max_buffered = 4096;  // entries waiting for the consumer before the walk pauses
+    unsigned types = EntryType::File | EntryType::Directory | EntryType::Symlink | EntryType::Other;
+};
+
+// Breadth-first walk of a directory tree with uv_fs_scandir on a libuv Scheduler. Entries are
+// yielded by co_await walker.next(), which resumes with std::nullopt when the walk is done.
+// The dirent type is used directly; only entries the file system reports as unknown are lstat'ed.
+// Symlinks are yielded but not followed. An unreadable root throws at next(); unreadable
+// directories below it are skipped and counted in skipped().
+class DirectoryWalker {
+public:
+    DirectoryWalker() = default;
+    DirectoryWalker(DirectoryWalker&&) noexcept = default;
+    DirectoryWalker& operator=(DirectoryWalker&& other) noexcept {
+        if (this != &other) {
+            detach();
+            state = std::move(other.state);
+        }
+        return *this;
+    }
+
+    ~DirectoryWalker() {
+        detach();
+    }
+
+private:
+    struct State;
+
+    enum class RequestKind { Scandir, Stat };
+
+    struct FsRequest {
+        uv_fs_t req;
+        State* owner;
+        RequestKind kind;
+        std::string path;
+        bool root = false;
+    };
+
+    struct State {
+        UvScheduler* scheduler = nullptr;
+        WalkOptions options;
+        std::deque<std::string> directories;  // breadth-first queue of directories to scan
+        std::deque<std::string> unknown;      // entries waiting for an lstat
+        std::deque<DirEntry> ready;
+        std::size_t in_flight = 0;
+        std::size_t stat_count = 0;
+        std::size_t skipped_count = 0;
+        int root_error = 0;
+        bool detached = false;
+        std::coroutine_handle<> waiter;
+        Priority priority = Priority::Normal;
+
+        bool finished() const {
+            return in_flight == 0 && directories.empty() && unknown.empty();
+        }
+    };
+
+public:
+    struct NextAwaitable {
+        State& state;
+
+        bool await_ready() { return !state.ready.empty() || state.root_error || state.finished(); }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> coro) {
+            state.waiter = coro;
+            state.priority = priority_of(coro);
+        }
+
+        std::optional<DirEntry> await_resume() {
+            if (state.root_error) {
+                throw std::system_error(-state.root_error, std::generic_category(), uv_strerror(state.root_error));
+            }
+            if (state.ready.empty()) {
+                return std::nullopt;
+            }
+            DirEntry entry = std::move(state.ready.front());
+            state.ready.pop_front();
+            pump(state);
+            return entry;
+        }
+    };
+
+    NextAwaitable next() { return NextAwaitable{*state}; }
+
+    // lstat calls issued because the dirent type was unknown
+    std::size_t stats() const { return state->stat_count; }
+
+    // Directories below the root that could not be read
+    std::size_t skipped() const { return state->skipped_count; }
+
+    friend Task<DirectoryWalker> walk_directory(UvScheduler& scheduler, std::string root, WalkOptions options);
+
+private:
+    explicit DirectoryWalker(std::unique_ptr<State> state) : state(std::move(state)) {}
+
+    // Requests still in flight free the state once the last one completes
+    void detach() {
+        if (!state) {
+            return;
+        }
+        if (state->in_flight == 0) {
+            state.reset();
+            return;
+        }
+        auto* raw = state.release();
+        raw->detached = true;
+        raw->directories.clear();
+        raw->unknown.clear();
+    }
+
+    static std::string join(const std::string& dir, const char* name) {
+        std::string path;
+        path.reserve(dir.size() + 1 + std::char_traits<char>::length(name));
+        path += dir;
+        if (path.empty() || path.back() != '/') {
+            path += '/';
+        }
+        path += name;
+        return path;
+    }
+
+    static std::optional<EntryType> from_dirent(uv_dirent_type_t type) {
+        switch (type) {
+            case UV_DIRENT_FILE: return EntryType::File;
+            case UV_DIRENT_DIR: return EntryType::Directory;
+            case UV_DIRENT_LINK: return EntryType::Symlink;
+            case UV_DIRENT_UNKNOWN: return std::nullopt;
+            default: return EntryType::Other;
+        }
+    }
+
+    static EntryType from_mode(std::uint64_t mode) {
+        if (S_ISREG(mode)) return EntryType::File;
+        if (S_ISDIR(mode)) return EntryType::Directory;
+        if (S_ISLNK(mode)) return EntryType::Symlink;
+        return EntryType::Other;
+    }
+
+    static void emit(State& state, std::string path, EntryType type) {
+        if (type == EntryType::Directory) {
+            state.directories.push_back(path);
+        }
+        if (state.options.types & static_cast<unsigned>(type)) {
+            state.ready.push_back(DirEntry{std::move(path), type});
+        }
+    }
+
+    static void wake(State& state) {
+        if (state.waiter && (!state.ready.empty() || state.root_error || state.finished())) {
+            state.scheduler->post(std::exchange(state.waiter, {}), state.priority);
+        }
+    }
+
+    // Issue requests up to the in-flight limit; pending lstats go first so their entries surface
+    // early, then directories in breadth-first order
+    static void pump(State& state) {
+        auto* loop = state.scheduler->get_loop();
+        while (state.in_flight < state.options.max_in_flight && state.ready.size() < state.options.max_buffered) {
+            std::unique_ptr<FsRequest> request;
+            if (!state.unknown.empty()) {
+                request.reset(new FsRequest{{}, &state, RequestKind::Stat, std::move(state.unknown.front())});
+                state.unknown.pop_front();
+            } else if (!state.directories.empty()) {
+                request.reset(new FsRequest{{}, &state, RequestKind::Scandir, std::move(state.directories.front())});
+                state.directories.pop_front();
+            } else {
+                break;
+            }
+            start(loop, std::move(request));
+        }
+    }
+
+    static void start(uv_loop_t* loop, std::unique_ptr<FsRequest> request) {
+        auto* raw = request.get();
+        raw->req.data = raw;
+        int res = raw->kind == RequestKind::Scandir
+            ? uv_fs_scandir(loop, &raw->req, raw->path.c_str(), 0, fs_cb)
+            : uv_fs_lstat(loop, &raw->req, raw->path.c_str(), fs_cb);
+        if (res < 0) {
+            // Submission failures are reported the same way as failed requests
+            raw->req.result = res;
+            complete(*raw);
+            uv_fs_req_cleanup(&raw->req);
+            return;
+        }
+        ++raw->owner->in_flight;
+        request.release();
+        if (raw->kind == RequestKind::Stat) {
+            ++raw->owner->stat_count;
+        }
+    }
+
+    static void complete(FsRequest& request) {
+        auto& state = *request.owner;
+        if (state.detached) {
+            return;
+        }
+        if (request.req.result < 0) {
+            if (request.root) {
+                state.root_error = static_cast<int>(request.req.result);
+            } else if (request.kind == RequestKind::Scandir) {
+                ++state.skipped_count;
+            }
+            // An entry that vanished before its lstat is dropped
+            return;
+        }
+        if (request.kind == RequestKind::Stat) {
+            emit(state, std::move(request.path), from_mode(request.req.statbuf.st_mode));
+            return;
+        }
+        uv_dirent_t dirent;
+        while (uv_fs_scandir_next(&request.req, &dirent) != UV_EOF) {
+            auto path = join(request.path, dirent.name);
+            if (auto type = from_dirent(dirent.type)) {
+                emit(state, std::move(path), *type);
+            } else {
+                state.unknown.push_back(std::move(path));
+            }
+        }
+    }
+
+    static void fs_cb(uv_fs_t* req) {
+        std::unique_ptr<FsRequest> request(static_cast<FsRequest*>(req->data));
+        auto* state = request->owner;
+        --state->in_flight;
+        complete(*request);
+        uv_fs_req_cleanup(req);
+        request.reset();
+
+        if (state->detached) {
+            if (state->in_flight == 0) {
+                delete state;
+            }
+            return;
+        }
+        pump(*state);
+        wake(*state);
+    }
+
+    std::unique_ptr<State> state;
+};
+
+// Start walking root; the walk runs in the background up to options.max_buffered entries ahead
+inline Task<DirectoryWalker> walk_directory(UvScheduler& scheduler, std::string root, WalkOptions options = {}) {
+    auto state = std::make_unique<DirectoryWalker::State>();
+    state->scheduler = &scheduler;
+    state->options = options;
+    if (state->options.max_in_flight == 0) {
+        state->options.max_in_flight = 1;
+    }
+
+    DirectoryWalker walker(std::move(state));
+    auto request = std::make_unique<DirectoryWalker::FsRequest>(
+        DirectoryWalker::FsRequest{{}, walker.state.get(), DirectoryWalker::RequestKind::Scandir, std::move(root), true});
+    DirectoryWalker::start(scheduler.get_loop(), std::move(request));
+    co_return walker;
+}
+
+template<typename Sched = Scheduler>
+Task<DirectoryWalker> walk_directory(std::string root, WalkOptions options = {}) {
+    static_assert(std::is_same_v<Sched, UvScheduler>, "walk_directory needs the libuv backend");
+    return walk_directory(static_cast<Sched&>(get_scheduler()), std::move(root), options);
+}
+
+
+#endif //CATCH2TESTEXAMPLE_DIRECTORY_WALKER_HPP
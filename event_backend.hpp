@@ -0,0 +1,38 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_EVENT_BACKEND_HPP
+#define CATCH2TESTEXAMPLE_EVENT_BACKEND_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Event backends are compile-time policies for BasicScheduler. A backend provides
+//
+//   Timer, Wakeup, IoRequest, Work      handle types with a `data` pointer and a `callback`
+//   Backend(void* owner, void (*drain)(void*))
+//   start_draining() / stop_draining()  call drain(owner) once per loop iteration without blocking
+//   start_timer(Timer&, delay)          one-shot timer, callback runs on the loop thread
+//   init_wakeup(Wakeup&) / close_wakeup(Wakeup&) / static send(Wakeup&)
+//                                       cross-thread wakeup that keeps the loop alive until closed
+//   submit(IoRequest&)                  read or write on a file or socket descriptor
+//   queue_work(Work&)                   run work(Work&) on a worker thread, then callback on the loop
+//   run()                               run until no handles or requests are pending
+
+enum class IoKind : std::uint8_t {
+    Read,
+    Write,
+};
+
+struct IoRequestBase {
+    IoKind kind = IoKind::Read;
+    int fd = -1;
+    void* buffer = nullptr;
+    std::size_t length = 0;
+    std::int64_t offset = -1;  // -1 uses and advances the descriptor's current position
+    std::ptrdiff_t result = 0;  // bytes transferred, or a negative errno
+};
+
+
+#endif //CATCH2TESTEXAMPLE_EVENT_BACKEND_HPP
@@ -0,0 +1,75 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_IO_HPP
+#define CATCH2TESTEXAMPLE_IO_HPP
+
+#include "scheduler.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <span>
+#include <system_error>
+
+// Read or write on a file or socket descriptor through the scheduler's event backend.
+// Resumes with the number of bytes transferred; errors are thrown as std::system_error.
+template<typename Sched>
+struct IoAwaitable {
+    IoAwaitable(Sched& scheduler, IoKind kind, int fd, void* buffer, std::size_t length, std::int64_t offset)
+        : scheduler(scheduler) {
+        request.kind = kind;
+        request.fd = fd;
+        request.buffer = buffer;
+        request.length = length;
+        request.offset = offset;
+    }
+
+    Sched& scheduler;
+    typename Sched::IoRequest request;
+    std::coroutine_handle<> coro;
+    Priority priority = Priority::Normal;
+
+    bool await_ready() { return false; }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> awaiting) {
+        coro = awaiting;
+        priority = priority_of(awaiting);
+        request.data = this;
+        request.callback = [](typename Sched::IoRequest& r) {
+            auto* self = static_cast<IoAwaitable*>(r.data);
+            self->scheduler.post(self->coro, self->priority);
+        };
+        scheduler.submit_io(request);
+    }
+
+    std::size_t await_resume() {
+        if (request.result < 0) {
+            throw std::system_error(static_cast<int>(-request.result), std::system_category(),
+                                    request.kind == IoKind::Read ? "read" : "write");
+        }
+        return static_cast<std::size_t>(request.result);
+    }
+};
+
+template<typename Sched>
+IoAwaitable<Sched> async_read(Sched& scheduler, int fd, std::span<std::byte> buffer, std::int64_t offset = -1) {
+    return {scheduler, IoKind::Read, fd, buffer.data(), buffer.size(), offset};
+}
+
+template<typename Sched>
+IoAwaitable<Sched> async_write(Sched& scheduler, int fd, std::span<const std::byte> buffer, std::int64_t offset = -1) {
+    return {scheduler, IoKind::Write, fd, const_cast<std::byte*>(buffer.data()), buffer.size(), offset};
+}
+
+inline IoAwaitable<Scheduler> async_read(int fd, std::span<std::byte> buffer, std::int64_t offset = -1) {
+    return async_read(get_scheduler(), fd, buffer, offset);
+}
+
+inline IoAwaitable<Scheduler> async_write(int fd, std::span<const std::byte> buffer, std::int64_t offset = -1) {
+    return async_write(get_scheduler(), fd, buffer, offset);
+}
+
+
+#endif //CATCH2TESTEXAMPLE_IO_HPP
@@ -0,0 +1,395 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_IPC_CHANNEL_HPP
+#define CATCH2TESTEXAMPLE_IPC_CHANNEL_HPP
+
+#include "scheduler.hpp"
+#include "task.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <uv.h>
+
+enum class IpcProducers : std::uint8_t {
+    Single,
+    Multiple,
+};
+
+namespace ipc_detail {
+    inline constexpr std::uint64_t magic = 0x6c617a796e632d31;  // "lazync-1"
+    inline constexpr std::size_t cache_line = 64;
+
+    // Start of the shared segment; producer and consumer indices live on separate cache lines
+    struct Header {
+        std::uint64_t magic = 0;
+        std::uint64_t capacity = 0;
+        std::uint64_t slot_size = 0;
+        std::uint64_t producers = 0;
+        alignas(cache_line) std::atomic<std::uint64_t> tail{0};  // next position producers claim
+        alignas(cache_line) std::atomic<std::uint64_t> head{0};  // next position the consumer reads
+        alignas(cache_line) std::atomic<std::uint32_t> consumer_waiting{0};
+    };
+
+    // sequence == position: free for the producer at that position
+    // sequence == position + 1: written, ready for the consumer
+    template<typename T>
+    struct Slot {
+        std::atomic<std::uint64_t> sequence;
+        T value;
+    };
+}
+
+// Bounded message ring in shared memory between processes on one host. Producers write messages
+// straight into the ring and the consumer reads them in place, so nothing passes through the
+// kernel. The consumer waits on an eventfd polled by a libuv Scheduler (uv_poll_t); it announces
+// that it is about to wait, and only the producer that ends such a wait writes the eventfd, so a
+// busy consumer costs producers no system calls.
+//
+// create() makes a new segment; pass memory_fd() and event_fd() to the other process (fork, or
+// SCM_RIGHTS, since both are close-on-exec) and attach() there. Any number of processes may send
+// with IpcProducers::Multiple, one with IpcProducers::Single; exactly one receives.
+template<typename T, IpcProducers Producers = IpcProducers::Multiple>
+class IpcChannel {
+    static_assert(std::is_trivially_copyable_v<T>, "IpcChannel messages are shared between processes as bytes");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+                  "IpcChannel needs address-free atomics");
+
+    using Header = ipc_detail::Header;
+    using Slot = ipc_detail::Slot<T>;
+
+    struct State;
+
+public:
+    IpcChannel() = default;
+    IpcChannel(IpcChannel&&) noexcept = default;
+    IpcChannel& operator=(IpcChannel&& other) noexcept {
+        if (this != &other) {
+            release();
+            state = std::move(other.state);
+        }
+        return *this;
+    }
+
+    ~IpcChannel() {
+        release();
+    }
+
+    // New segment with room for capacity messages, rounded up to a power of two
+    static IpcChannel create(std::size_t capacity) {
+        capacity = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+        auto state = std::make_unique<State>();
+        state->memory_fd = memfd_create("lazync-ipc", MFD_CLOEXEC);
+        if (state->memory_fd < 0) {
+            throw std::system_error(errno, std::system_category(), "memfd_create");
+        }
+        state->length = segment_size(capacity);
+        if (ftruncate(state->memory_fd, static_cast<off_t>(state->length)) < 0) {
+            throw std::system_error(errno, std::system_category(), "ftruncate");
+        }
+        state->map();
+        state->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (state->event_fd < 0) {
+            throw std::system_error(errno, std::system_category(), "eventfd");
+        }
+
+        auto* header = new (state->base) Header;
+        header->capacity = capacity;
+        header->slot_size = sizeof(Slot);
+        header->producers = static_cast<std::uint64_t>(Producers);
+        state->header = header;
+        state->slots = reinterpret_cast<Slot*>(state->base + sizeof(Header));
+        state->mask = capacity - 1;
+        for (std::size_t i = 0; i < capacity; ++i) {
+            new (&state->slots[i].sequence) std::atomic<std::uint64_t>(i);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = ipc_detail::magic;
+        return IpcChannel(std::move(state));
+    }
+
+    // Map a segment made by create() in another process; takes ownership of both descriptors
+    static IpcChannel attach(int memory_fd, int event_fd) {
+        auto state = std::make_unique<State>();
+        state->memory_fd = memory_fd;
+        state->event_fd = event_fd;
+        struct stat st{};
+        if (fstat(memory_fd, &st) < 0) {
+            throw std::system_error(errno, std::system_category(), "fstat");
+        }
+        state->length = static_cast<std::size_t>(st.st_size);
+        if (state->length < sizeof(Header)) {
+            throw std::invalid_argument("IpcChannel: not a channel segment");
+        }
+        state->map();
+
+        auto* header = std::launder(reinterpret_cast<Header*>(state->base));
+        if (header->magic != ipc_detail::magic || header->slot_size != sizeof(Slot)
+            || header->producers != static_cast<std::uint64_t>(Producers)
+            || !std::has_single_bit(header->capacity) || segment_size(header->capacity) != state->length) {
+            throw std::invalid_argument("IpcChannel: segment was created for a different message type or mode");
+        }
+        state->header = header;
+        state->slots = std::launder(reinterpret_cast<Slot*>(state->base + sizeof(Header)));
+        state->mask = header->capacity - 1;
+        return IpcChannel(std::move(state));
+    }
+
+    int memory_fd() const { return state->memory_fd; }
+    int event_fd() const { return state->event_fd; }
+    std::size_t capacity() const { return state->mask + 1; }
+
+    // Producer side: false if the ring is full
+    bool try_send(const T& message) {
+        return try_send_with([&message](T& slot) { slot = message; });
+    }
+
+    // Producer side: fill(T&) writes the message directly into its slot
+    template<typename F>
+    bool try_send_with(F&& fill) {
+        auto& header = *state->header;
+        auto pos = header.tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &state->slots[pos & state->mask];
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::int64_t>(sequence - pos);
+            if (lag == 0) {
+                if constexpr (Producers == IpcProducers::Single) {
+                    header.tail.store(pos + 1, std::memory_order_relaxed);
+                    break;
+                } else if (header.tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                // The consumer has not released this slot from the previous lap yet
+                return false;
+            } else {
+                pos = header.tail.load(std::memory_order_relaxed);
+            }
+        }
+        fill(slot->value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        // Pairs with the fence in State::arm(): either the consumer sees this message before it
+        // waits, or this sees that it waits
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header.consumer_waiting.load(std::memory_order_relaxed)
+            && header.consumer_waiting.exchange(0, std::memory_order_relaxed)) {
+            const std::uint64_t one = 1;
+            [[maybe_unused]] auto n = write(state->event_fd, &one, sizeof(one));
+        }
+        return true;
+    }
+
+    // Consumer side, without waiting
+    std::optional<T> try_receive() {
+        std::optional<T> message;
+        state->pop([&message](const T& value) { message = value; });
+        return message;
+    }
+
+    // Consumer side: calls consume(const T&) on every message available now, in place
+    template<typename F>
+    std::size_t drain(F&& consume) {
+        std::size_t count = 0;
+        while (state->pop(consume)) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Resumes once a message is available; use try_receive() or drain() to take it
+    struct ReadableAwaitable {
+        State& state;
+        UvScheduler& scheduler;
+
+        bool await_ready() { return state.ready(); }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> coro) {
+            if (!state.arm()) {
+                return false;
+            }
+            state.wait(scheduler, coro, priority_of(coro));
+            return true;
+        }
+
+        void await_resume() {
+            if (state.error) {
+                throw std::system_error(-std::exchange(state.error, 0), std::generic_category(), "IpcChannel poll");
+            }
+        }
+    };
+
+    struct ReceiveAwaitable : ReadableAwaitable {
+        T await_resume() {
+            ReadableAwaitable::await_resume();
+            std::optional<T> message;
+            this->state.pop([&message](const T& value) { message = value; });
+            return *message;
+        }
+    };
+
+    ReadableAwaitable readable(UvScheduler& scheduler) { return ReadableAwaitable{*state, scheduler}; }
+    ReceiveAwaitable receive(UvScheduler& scheduler) { return ReceiveAwaitable{{*state, scheduler}}; }
+
+    template<typename Sched = Scheduler>
+    ReceiveAwaitable receive() {
+        static_assert(std::is_same_v<Sched, UvScheduler>, "IpcChannel waits with uv_poll and needs the libuv backend");
+        return receive(static_cast<Sched&>(get_scheduler()));
+    }
+
+private:
+    struct State {
+        int memory_fd = -1;
+        int event_fd = -1;
+        std::byte* base = nullptr;
+        std::size_t length = 0;
+        Header* header = nullptr;
+        Slot* slots = nullptr;
+        std::uint64_t mask = 0;
+
+        // Consumer side, on the loop thread
+        UvScheduler* scheduler = nullptr;
+        uv_poll_t poll;
+        bool polling = false;
+        std::coroutine_handle<> waiter;
+        Priority priority = Priority::Normal;
+        int error = 0;
+
+        State() = default;
+        State(const State&) = delete;
+        State& operator=(const State&) = delete;
+
+        ~State() {
+            if (base) {
+                munmap(base, length);
+            }
+            if (memory_fd >= 0) {
+                ::close(memory_fd);
+            }
+            if (event_fd >= 0) {
+                ::close(event_fd);
+            }
+        }
+
+        void map() {
+            void* ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+            if (ptr == MAP_FAILED) {
+                throw std::system_error(errno, std::system_category(), "mmap");
+            }
+            base = static_cast<std::byte*>(ptr);
+        }
+
+        bool ready() const {
+            const auto pos = header->head.load(std::memory_order_relaxed);
+            return slots[pos & mask].sequence.load(std::memory_order_acquire) == pos + 1;
+        }
+
+        template<typename F>
+        bool pop(F&& consume) {
+            const auto pos = header->head.load(std::memory_order_relaxed);
+            auto& slot = slots[pos & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                return false;
+            }
+            consume(std::as_const(slot.value));
+            slot.sequence.store(pos + mask + 1, std::memory_order_release);
+            header->head.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Announce a wait, then look once more; false if a message arrived in between
+        bool arm() {
+            header->consumer_waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready()) {
+                header->consumer_waiting.store(0, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        // The poll handle stays started between waits and is only unref'd, which saves an
+        // epoll_ctl pair per wait while still letting the loop exit when nobody is waiting
+        void wait(UvScheduler& on, std::coroutine_handle<> coro, Priority p) {
+            if (!polling) {
+                scheduler = &on;
+                int res = uv_poll_init(on.get_loop(), &poll, event_fd);
+                if (res < 0) {
+                    throw std::system_error(-res, std::generic_category(), uv_strerror(res));
+                }
+                poll.data = this;
+                uv_poll_start(&poll, UV_READABLE, poll_cb);
+                polling = true;
+            } else if (scheduler != &on) {
+                throw std::logic_error("IpcChannel: receive on a different scheduler");
+            } else {
+                uv_ref(reinterpret_cast<uv_handle_t*>(&poll));
+            }
+            waiter = coro;
+            priority = p;
+        }
+
+        static void poll_cb(uv_poll_t* handle, int status, int) {
+            auto* self = static_cast<State*>(handle->data);
+            std::uint64_t count;
+            [[maybe_unused]] auto n = read(self->event_fd, &count, sizeof(count));
+            if (!self->waiter) {
+                return;
+            }
+            if (status < 0) {
+                self->error = status;
+            } else if (self->arm()) {
+                // Left over from a wait that ended without sleeping; keep waiting
+                return;
+            }
+            uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+            self->scheduler->post(std::exchange(self->waiter, {}), self->priority);
+        }
+    };
+
+    explicit IpcChannel(std::unique_ptr<State> state) : state(std::move(state)) {}
+
+    static std::size_t segment_size(std::size_t capacity) {
+        return sizeof(Header) + capacity * sizeof(Slot);
+    }
+
+    // The eventfd stays open until the poll handle is closed
+    void release() {
+        if (!state) {
+            return;
+        }
+        if (!state->polling) {
+            state.reset();
+            return;
+        }
+        auto* raw = state.release();
+        uv_close(reinterpret_cast<uv_handle_t*>(&raw->poll), [](uv_handle_t* handle) {
+            delete static_cast<State*>(handle->data);
+        });
+    }
+
+    std::unique_ptr<State> state;
+};
+
+
+#endif //CATCH2TESTEXAMPLE_IPC_CHANNEL_HPP
@@ -0,0 +1,210 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_LATENCY_HISTOGRAM_HPP
+#define CATCH2TESTEXAMPLE_LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Log-linear (HDR-style) histogram of nanosecond values: values below 64 get exact buckets, larger
+// ones 32 buckets per power of two (about 3% relative error), up to about 18 minutes. It has a
+// single writer and can be read from other threads at any time.
+class LatencyHistogram {
+public:
+    static constexpr unsigned sub_bits = 6;
+    static constexpr unsigned max_bits = 40;
+    static constexpr std::uint64_t max_value = (std::uint64_t{1} << max_bits) - 1;
+    static constexpr std::size_t bucket_count = (max_bits - sub_bits) * (std::size_t{1} << (sub_bits - 1))
+                                                + (std::size_t{1} << sub_bits);
+
+    // Owner thread only; the read-modify-write needs no lock prefix since nobody else writes
+    void record(std::uint64_t value) {
+        auto& bucket = buckets[bucket_index(value < max_value ? value : max_value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count(std::size_t index) const {
+        return buckets[index].load(std::memory_order_relaxed);
+    }
+
+    static constexpr std::size_t bucket_index(std::uint64_t value) {
+        constexpr std::uint64_t linear = std::uint64_t{1} << sub_bits;
+        if (value < linear) {
+            return static_cast<std::size_t>(value);
+        }
+        const unsigned shift = std::bit_width(value) - sub_bits;
+        return static_cast<std::size_t>(shift) * (linear / 2) + static_cast<std::size_t>(value >> shift);
+    }
+
+    // Largest value that falls into the bucket
+    static constexpr std::uint64_t bucket_high(std::size_t index) {
+        constexpr std::size_t linear = std::size_t{1} << sub_bits;
+        if (index < linear) {
+            return index;
+        }
+        const std::size_t shift = index / (linear / 2) - 1;
+        const std::uint64_t mantissa = index % (linear / 2) + linear / 2;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets{};
+};
+
+static_assert(LatencyHistogram::bucket_index(LatencyHistogram::max_value) + 1 == LatencyHistogram::bucket_count);
+static_assert(LatencyHistogram::bucket_high(LatencyHistogram::bucket_count - 1) == LatencyHistogram::max_value);
+
+// Merged copy of one or more histograms
+class LatencySnapshot {
+public:
+    void merge(const LatencyHistogram& histogram) {
+        for (std::size_t i = 0; i < LatencyHistogram::bucket_count; ++i) {
+            const auto n = histogram.count(i);
+            counts[i] += n;
+            total += n;
+        }
+    }
+
+    std::uint64_t count() const { return total; }
+
+    // Highest value equivalent to the given percentile (0-100) of the recorded values
+    std::chrono::nanoseconds percentile(double p) const {
+        if (total == 0) {
+            return std::chrono::nanoseconds(0);
+        }
+        auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+        rank = std::max<std::uint64_t>(1, std::min(rank, total));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < LatencyHistogram::bucket_count; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::chrono::nanoseconds(LatencyHistogram::bucket_high(i));
+            }
+        }
+        return std::chrono::nanoseconds(LatencyHistogram::max_value);
+    }
+
+    std::chrono::nanoseconds max() const { return percentile(100.0); }
+
+private:
+    std::array<std::uint64_t, LatencyHistogram::bucket_count> counts{};
+    std::uint64_t total = 0;
+};
+
+struct TaskLatency {
+    LatencySnapshot wall;  // from co_await named(...) until the task completed
+    LatencySnapshot cpu;   // time the task was actually running over the same span
+};
+
+namespace latency_detail {
+    struct NamedHistograms {
+        explicit NamedHistograms(const char* name) : name(name) {}
+
+        const char* name;
+        LatencyHistogram wall;
+        LatencyHistogram cpu;
+        NamedHistograms* next = nullptr;
+    };
+
+    // One thread's histograms: an append-only list that readers walk without locking
+    struct ThreadHistograms {
+        std::atomic<NamedHistograms*> head{nullptr};
+
+        ~ThreadHistograms() {
+            for (auto* node = head.load(); node;) {
+                delete std::exchange(node, node->next);
+            }
+        }
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadHistograms>> threads;  // kept after their thread exits
+
+        static Registry& instance() {
+            static Registry registry;
+            return registry;
+        }
+    };
+
+    struct LocalHistograms {
+        std::shared_ptr<ThreadHistograms> histograms = std::make_shared<ThreadHistograms>();
+        std::unordered_map<const char*, NamedHistograms*> index;
+
+        LocalHistograms() {
+            auto& registry = Registry::instance();
+            std::lock_guard lock(registry.mutex);
+            registry.threads.push_back(histograms);
+        }
+
+        NamedHistograms& find(const char* name) {
+            auto it = index.find(name);
+            if (it != index.end()) {
+                return *it->second;
+            }
+            // First completion of this name on this thread
+            auto* node = new NamedHistograms(name);
+            node->next = histograms->head.load(std::memory_order_relaxed);
+            histograms->head.store(node, std::memory_order_release);
+            index.emplace(name, node);
+            return *node;
+        }
+
+        static LocalHistograms& get() {
+            thread_local LocalHistograms local;
+            return local;
+        }
+    };
+}
+
+// Called when a named task completes, on the thread that completed it
+inline void record_task_latency(const char* name, std::uint64_t wall_ns, std::uint64_t cpu_ns) {
+    auto& histograms = latency_detail::LocalHistograms::get().find(name);
+    histograms.wall.record(wall_ns);
+    histograms.cpu.record(cpu_ns);
+}
+
+// Per-thread histograms merged by task name
+inline std::map<std::string, TaskLatency, std::less<>> task_latencies() {
+    std::vector<std::shared_ptr<latency_detail::ThreadHistograms>> threads;
+    {
+        auto& registry = latency_detail::Registry::instance();
+        std::lock_guard lock(registry.mutex);
+        threads = registry.threads;
+    }
+
+    std::map<std::string, TaskLatency, std::less<>> result;
+    for (auto& thread : threads) {
+        for (auto* node = thread->head.load(std::memory_order_acquire); node; node = node->next) {
+            auto& latency = result[node->name];
+            latency.wall.merge(node->wall);
+            latency.cpu.merge(node->cpu);
+        }
+    }
+    return result;
+}
+
+inline TaskLatency task_latency(std::string_view name) {
+    auto all = task_latencies();
+    auto it = all.find(name);
+    return it == all.end() ? TaskLatency{} : it->second;
+}
+
+
+#endif //CATCH2TESTEXAMPLE_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,254 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_MAPPED_FILE_HPP
+#define CATCH2TESTEXAMPLE_MAPPED_FILE_HPP
+
+#include "offload.hpp"
+#include "scheduler.hpp"
+#include "task.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <fcntl.h>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::system_category(), "open " + path);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) < 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "fstat " + path);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        if (length > 0) {
+            void* ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::system_category(), "mmap " + path);
+            }
+            data = static_cast<const std::byte*>(ptr);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data = std::exchange(other.data, nullptr);
+            length = std::exchange(other.length, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const std::byte> bytes() const { return {data, length}; }
+    std::size_t size() const { return length; }
+
+    // Access-pattern hint for [offset, offset + len); offset is rounded down to a page boundary
+    void advise(std::size_t offset, std::size_t len, int advice) const {
+        if (!data || offset >= length) {
+            return;
+        }
+        const auto aligned = offset - offset % page_size();
+        len = std::min(len + (offset - aligned), length - aligned);
+        madvise(const_cast<std::byte*>(data) + aligned, len, advice);
+    }
+
+    static std::size_t page_size() {
+        static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+private:
+    void unmap() {
+        if (data) {
+            munmap(const_cast<std::byte*>(data), length);
+            data = nullptr;
+        }
+    }
+
+    const std::byte* data = nullptr;
+    std::size_t length = 0;
+};
+
+// Sequential zero-copy chunks over a MappedFile. co_await chunks.next() resumes with a view of the
+// next chunk, or std::nullopt at end of file. A window of readahead_chunks ahead of the consumer is
+// madvise(MADV_WILLNEED)'d and prefaulted on a worker thread, so page faults do not stall the loop;
+// next() only suspends when the consumer has caught up with the prefaulted window.
+class MappedChunks {
+public:
+    MappedChunks() = default;
+
+    MappedChunks(MappedFile file, std::size_t chunk_size, std::size_t readahead_chunks, Scheduler& scheduler)
+        : state(std::make_unique<State>(std::move(file), chunk_size, readahead_chunks, scheduler)) {
+        state->file.advise(0, state->file.size(), MADV_SEQUENTIAL);
+        state->start_prefault();
+    }
+
+    MappedChunks(MappedChunks&&) noexcept = default;
+    MappedChunks& operator=(MappedChunks&& other) noexcept {
+        if (this != &other) {
+            release();
+            state = std::move(other.state);
+        }
+        return *this;
+    }
+
+    ~MappedChunks() {
+        release();
+    }
+
+    struct NextAwaitable {
+        MappedChunks& chunks;
+
+        bool await_ready() { return chunks.state->chunk_ready(); }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> coro) {
+            auto& state = *chunks.state;
+            state.waiter = coro;
+            state.priority = priority_of(coro);
+            state.start_prefault();
+        }
+
+        std::optional<std::span<const std::byte>> await_resume() {
+            return chunks.state->take_chunk();
+        }
+    };
+
+    NextAwaitable next() { return NextAwaitable{*this}; }
+
+    const MappedFile& file() const { return state->file; }
+
+    // End of the range that has been prefaulted so far
+    std::size_t prefaulted() const { return state->prefaulted_end; }
+
+private:
+    // An in-flight prefault still references the mapping, so it frees the state when it finishes
+    void release() {
+        if (state && state->prefaulting) {
+            state.release()->orphaned = true;
+        }
+        state.reset();
+    }
+
+    struct State {
+        State(MappedFile file, std::size_t chunk_size, std::size_t readahead_chunks, Scheduler& scheduler)
+            : file(std::move(file)), chunk_size(std::max<std::size_t>(1, chunk_size)),
+              window(this->chunk_size * std::max<std::size_t>(1, readahead_chunks)), scheduler(scheduler) {}
+
+        bool chunk_ready() const {
+            return position >= file.size() || std::min(position + chunk_size, file.size()) <= prefaulted_end;
+        }
+
+        void start_prefault() {
+            if (prefaulting || prefaulted_end >= file.size()) {
+                return;
+            }
+            prefault_begin = prefaulted_end;
+            prefault_end = std::min(file.size(), std::max(prefaulted_end, position) + window);
+            file.advise(prefault_begin, prefault_end - prefault_begin, MADV_WILLNEED);
+
+            prefaulting = true;
+            work.data = this;
+            work.work = [](Scheduler::Work& w) {
+                auto* self = static_cast<State*>(w.data);
+                const auto bytes = self->file.bytes();
+                std::byte sink{};
+                for (auto i = self->prefault_begin; i < self->prefault_end; i += MappedFile::page_size()) {
+                    sink ^= *static_cast<const volatile std::byte*>(&bytes[i]);
+                }
+                self->touched = sink;
+            };
+            work.callback = [](Scheduler::Work& w) {
+                auto* self = static_cast<State*>(w.data);
+                self->prefaulting = false;
+                if (self->orphaned) {
+                    delete self;
+                    return;
+                }
+                self->prefaulted_end = self->prefault_end;
+                if (self->waiter) {
+                    if (self->chunk_ready()) {
+                        self->scheduler.post(std::exchange(self->waiter, {}), self->priority);
+                    } else {
+                        self->start_prefault();
+                    }
+                }
+            };
+            scheduler.queue_work(work);
+        }
+
+        std::optional<std::span<const std::byte>> take_chunk() {
+            if (position >= file.size()) {
+                return std::nullopt;
+            }
+            const auto len = std::min(chunk_size, file.size() - position);
+            auto chunk = file.bytes().subspan(position, len);
+            position += len;
+            // Keep a full window ahead of the consumer
+            if (prefaulted_end < position + window) {
+                start_prefault();
+            }
+            return chunk;
+        }
+
+        MappedFile file;
+        std::size_t chunk_size;
+        std::size_t window;
+        Scheduler& scheduler;
+        std::size_t position = 0;
+        std::size_t prefaulted_end = 0;
+        std::size_t prefault_begin = 0;
+        std::size_t prefault_end = 0;
+        bool prefaulting = false;
+        bool orphaned = false;
+        std::byte touched{};
+        Scheduler::Work work;
+        std::coroutine_handle<> waiter;
+        Priority priority = Priority::Normal;
+    };
+
+    std::unique_ptr<State> state;
+};
+
+// Map a file (open and mmap run on a worker thread) and read it in chunk_size views
+inline Task<MappedChunks> mapped_chunks(std::string path, std::size_t chunk_size, std::size_t readahead_chunks = 4) {
+    auto open = [&path] { return MappedFile(path); };
+    auto file = co_await offload(open);
+    co_return MappedChunks(std::move(file), chunk_size, readahead_chunks, get_scheduler());
+}
+
+
+#endif //CATCH2TESTEXAMPLE_MAPPED_FILE_HPP
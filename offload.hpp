@@ -0,0 +1,86 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_OFFLOAD_HPP
+#define CATCH2TESTEXAMPLE_OFFLOAD_HPP
+
+#include "scheduler.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Run a callable on the scheduler's worker threads and resume with its result on the loop thread.
+// Exceptions thrown by the callable are rethrown at the co_await.
+template<typename Sched, typename F>
+class OffloadAwaitable {
+public:
+    using Result = std::invoke_result_t<F&>;
+
+    OffloadAwaitable(Sched& scheduler, F fn) : scheduler(scheduler), fn(std::move(fn)) {}
+
+    bool await_ready() { return false; }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> awaiting) {
+        coro = awaiting;
+        priority = priority_of(awaiting);
+        work.data = this;
+        work.work = [](typename Sched::Work& w) {
+            static_cast<OffloadAwaitable*>(w.data)->invoke();
+        };
+        work.callback = [](typename Sched::Work& w) {
+            auto* self = static_cast<OffloadAwaitable*>(w.data);
+            self->scheduler.post(self->coro, self->priority);
+        };
+        scheduler.queue_work(work);
+    }
+
+    Result await_resume() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*result);
+        }
+    }
+
+private:
+    struct Empty {};
+
+    void invoke() {
+        try {
+            if constexpr (std::is_void_v<Result>) {
+                fn();
+            } else {
+                result.emplace(fn());
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+    }
+
+    Sched& scheduler;
+    F fn;
+    std::conditional_t<std::is_void_v<Result>, Empty, std::optional<Result>> result;
+    std::exception_ptr exception;
+    typename Sched::Work work;
+    std::coroutine_handle<> coro;
+    Priority priority = Priority::Normal;
+};
+
+template<typename Sched, typename F>
+OffloadAwaitable<Sched, std::decay_t<F>> offload(Sched& scheduler, F&& fn) {
+    return {scheduler, std::forward<F>(fn)};
+}
+
+template<typename F>
+OffloadAwaitable<Scheduler, std::decay_t<F>> offload(F&& fn) {
+    return {get_scheduler(), std::forward<F>(fn)};
+}
+
+
+#endif //CATCH2TESTEXAMPLE_OFFLOAD_HPP
@@ -0,0 +1,166 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_PARALLEL_HPP
+#define CATCH2TESTEXAMPLE_PARALLEL_HPP
+
+#include "offload.hpp"
+#include "scheduler.hpp"
+#include "task.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Parallel algorithms over coroutines. The input is split into chunks that run on the scheduler's
+// worker threads, at most max_parallel at a time; the awaiting coroutine resumes on the loop thread.
+// The range must stay alive until the returned task completes.
+
+struct ParallelOptions {
+    std::size_t chunk_size = 0;    // 0 picks about four chunks per lane
+    std::size_t max_parallel = 0;  // 0 uses std::thread::hardware_concurrency()
+};
+
+namespace parallel_detail {
+    struct Plan {
+        std::size_t size;
+        std::size_t chunk_size;
+        std::size_t chunks;
+        std::size_t lanes;
+
+        std::size_t begin(std::size_t chunk) const { return chunk * chunk_size; }
+        std::size_t end(std::size_t chunk) const { return std::min(size, begin(chunk) + chunk_size); }
+    };
+
+    inline Plan plan(std::size_t size, ParallelOptions options) {
+        const std::size_t parallel = options.max_parallel
+            ? options.max_parallel
+            : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        const std::size_t chunk_size = options.chunk_size
+            ? options.chunk_size
+            : std::max<std::size_t>(1, (size + 4 * parallel - 1) / (4 * parallel));
+        const std::size_t chunks = (size + chunk_size - 1) / chunk_size;
+        return Plan{size, chunk_size, chunks, std::min(parallel, chunks)};
+    }
+
+    // One lane keeps a single chunk in flight and pulls the next index when it finishes
+    template<typename Sched, typename F>
+    Task<void> lane(Sched* scheduler, const Plan* plan, std::size_t* next, F* chunk) {
+        while (*next < plan->chunks) {
+            const std::size_t index = (*next)++;
+            co_await offload(*scheduler, [chunk, index] { (*chunk)(index); });
+        }
+    }
+
+    template<typename Sched, typename F>
+    Task<void> run_chunks(Sched& scheduler, Plan plan, F& chunk) {
+        std::size_t next = 0;
+        std::vector<Task<void>> lanes;
+        lanes.reserve(plan.lanes);
+        for (std::size_t i = 0; i < plan.lanes; ++i) {
+            lanes.push_back(lane(&scheduler, &plan, &next, &chunk));
+        }
+        co_await when_all(std::move(lanes));
+    }
+}
+
+// Apply f to every element. Each result is written in place into its own slot, never a packed
+// std::vector<bool>, so chunks on different workers do not share memory.
+template<typename Sched, std::ranges::random_access_range R, typename F>
+    requires std::ranges::sized_range<R>
+Task<std::vector<std::invoke_result_t<F&, std::ranges::range_reference_t<R>>>>
+async_transform(Sched& scheduler, R& range, F f, ParallelOptions options = {}) {
+    using U = std::invoke_result_t<F&, std::ranges::range_reference_t<R>>;
+
+    const auto plan = parallel_detail::plan(std::ranges::size(range), options);
+    std::vector<std::optional<U>> slots(plan.size);
+    auto first = std::ranges::begin(range);
+
+    auto chunk = [&](std::size_t index) {
+        for (auto i = plan.begin(index); i < plan.end(index); ++i) {
+            slots[i].emplace(f(first[i]));
+        }
+    };
+    co_await parallel_detail::run_chunks(scheduler, plan, chunk);
+
+    std::vector<U> results;
+    results.reserve(slots.size());
+    for (auto& slot : slots) {
+        results.push_back(std::move(*slot));
+    }
+    co_return results;
+}
+
+template<std::ranges::random_access_range R, typename F>
+    requires std::ranges::sized_range<R>
+auto async_transform(R& range, F f, ParallelOptions options = {}) {
+    return async_transform(get_scheduler(), range, std::move(f), options);
+}
+
+// Fold with an associative op: each chunk is reduced on a worker, then the per-chunk partials
+// are combined pairwise in a tree and finally folded into init
+template<typename Sched, std::ranges::random_access_range R, typename T, typename Op>
+    requires std::ranges::sized_range<R>
+Task<T> async_reduce(Sched& scheduler, R& range, T init, Op op, ParallelOptions options = {}) {
+    const auto plan = parallel_detail::plan(std::ranges::size(range), options);
+    std::vector<std::optional<T>> partials(plan.chunks);
+    auto first = std::ranges::begin(range);
+
+    auto chunk = [&](std::size_t index) {
+        auto i = plan.begin(index);
+        T partial = first[i];
+        for (++i; i < plan.end(index); ++i) {
+            partial = op(std::move(partial), first[i]);
+        }
+        partials[index].emplace(std::move(partial));
+    };
+    co_await parallel_detail::run_chunks(scheduler, plan, chunk);
+
+    for (std::size_t stride = 1; stride < partials.size(); stride *= 2) {
+        for (std::size_t i = 0; i + stride < partials.size(); i += 2 * stride) {
+            partials[i].emplace(op(std::move(*partials[i]), std::move(*partials[i + stride])));
+        }
+    }
+
+    if (partials.empty()) {
+        co_return init;
+    }
+    co_return op(std::move(init), std::move(*partials.front()));
+}
+
+template<std::ranges::random_access_range R, typename T, typename Op>
+    requires std::ranges::sized_range<R>
+auto async_reduce(R& range, T init, Op op, ParallelOptions options = {}) {
+    return async_reduce(get_scheduler(), range, std::move(init), std::move(op), options);
+}
+
+template<typename Sched, std::ranges::random_access_range R, typename F>
+    requires std::ranges::sized_range<R>
+Task<void> async_for_each(Sched& scheduler, R& range, F f, ParallelOptions options = {}) {
+    const auto plan = parallel_detail::plan(std::ranges::size(range), options);
+    auto first = std::ranges::begin(range);
+
+    auto chunk = [&](std::size_t index) {
+        for (auto i = plan.begin(index); i < plan.end(index); ++i) {
+            f(first[i]);
+        }
+    };
+    co_await parallel_detail::run_chunks(scheduler, plan, chunk);
+}
+
+template<std::ranges::random_access_range R, typename F>
+    requires std::ranges::sized_range<R>
+auto async_for_each(R& range, F f, ParallelOptions options = {}) {
+    return async_for_each(get_scheduler(), range, std::move(f), options);
+}
+
+
+#endif //CATCH2TESTEXAMPLE_PARALLEL_HPP
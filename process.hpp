@@ -0,0 +1,328 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_PROCESS_HPP
+#define CATCH2TESTEXAMPLE_PROCESS_HPP
+
+#include "scheduler.hpp"
+#include "task.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <uv.h>
+#include <vector>
+
+// Free list of fixed-size pipe read buffers, one per loop thread
+class PipeBufferPool {
+public:
+    static constexpr std::size_t buffer_size = 64 * 1024;
+    static constexpr std::size_t max_free = 64;
+
+    std::unique_ptr<std::byte[]> acquire() {
+        if (free.empty()) {
+            return std::make_unique_for_overwrite<std::byte[]>(buffer_size);
+        }
+        auto buffer = std::move(free.back());
+        free.pop_back();
+        return buffer;
+    }
+
+    void release(std::unique_ptr<std::byte[]> buffer) {
+        if (buffer && free.size() < max_free) {
+            free.push_back(std::move(buffer));
+        }
+    }
+
+    std::size_t free_count() const { return free.size(); }
+
+    static PipeBufferPool& local() {
+        thread_local PipeBufferPool pool;
+        return pool;
+    }
+
+private:
+    std::vector<std::unique_ptr<std::byte[]>> free;
+};
+
+// Bytes read from a child's stdout or stderr; the buffer goes back to the pool on destruction
+class PipeChunk {
+public:
+    PipeChunk(std::unique_ptr<std::byte[]> buffer, std::size_t size) : buffer(std::move(buffer)), size(size) {}
+    PipeChunk(PipeChunk&&) noexcept = default;
+    PipeChunk& operator=(PipeChunk&&) noexcept = default;
+
+    ~PipeChunk() {
+        PipeBufferPool::local().release(std::move(buffer));
+    }
+
+    std::span<const std::byte> bytes() const { return {buffer.get(), size}; }
+    std::string_view text() const { return {reinterpret_cast<const char*>(buffer.get()), size}; }
+
+private:
+    std::unique_ptr<std::byte[]> buffer;
+    std::size_t size;
+};
+
+struct ExitStatus {
+    std::int64_t exit_status = 0;
+    int term_signal = 0;
+};
+
+// Child process started with uv_spawn on a libuv Scheduler. stdout and stderr are read in chunks
+// with co_await proc.read_stdout() / read_stderr(), which resume with std::nullopt at end of stream.
+class Process {
+public:
+    // Chunks queued per stream before reading pauses until the consumer catches up
+    static constexpr std::size_t max_queued_chunks = 16;
+
+    Process() = default;
+    Process(Process&&) noexcept = default;
+    Process& operator=(Process&& other) noexcept {
+        if (this != &other) {
+            detach();
+            state = std::move(other.state);
+        }
+        return *this;
+    }
+
+    ~Process() {
+        detach();
+    }
+
+private:
+    struct State;
+
+    struct OutputPipe {
+        uv_pipe_t pipe;
+        State* owner = nullptr;
+        std::deque<PipeChunk> chunks;
+        std::unique_ptr<std::byte[]> reading;  // buffer lent to libuv for the next read
+        bool open = true;
+        bool paused = false;
+        bool eof = false;
+        int error = 0;
+        std::coroutine_handle<> waiter;
+        Priority priority = Priority::Normal;
+    };
+
+    struct State {
+        UvScheduler* scheduler = nullptr;
+        uv_process_t process;
+        OutputPipe out;
+        OutputPipe err;
+        ExitStatus status;
+        bool exited = false;
+        bool process_open = true;
+        bool detached = false;
+        int open_handles = 3;
+        std::coroutine_handle<> waiter;
+        Priority priority = Priority::Normal;
+    };
+
+public:
+    struct ReadAwaitable {
+        OutputPipe& pipe;
+
+        bool await_ready() { return !pipe.chunks.empty() || pipe.eof || pipe.error; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> coro) {
+            pipe.waiter = coro;
+            pipe.priority = priority_of(coro);
+        }
+
+        std::optional<PipeChunk> await_resume() {
+            if (!pipe.chunks.empty()) {
+                PipeChunk chunk = std::move(pipe.chunks.front());
+                pipe.chunks.pop_front();
+                if (pipe.paused && pipe.chunks.size() < max_queued_chunks / 2) {
+                    pipe.paused = false;
+                    uv_read_start(reinterpret_cast<uv_stream_t*>(&pipe.pipe), alloc_cb, read_cb);
+                }
+                return chunk;
+            }
+            if (pipe.error) {
+                throw std::system_error(-pipe.error, std::generic_category(), uv_strerror(pipe.error));
+            }
+            return std::nullopt;
+        }
+    };
+
+    struct WaitAwaitable {
+        State& state;
+
+        bool await_ready() { return state.exited; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> coro) {
+            state.waiter = coro;
+            state.priority = priority_of(coro);
+        }
+
+        ExitStatus await_resume() { return state.status; }
+    };
+
+    ReadAwaitable read_stdout() { return ReadAwaitable{state->out}; }
+    ReadAwaitable read_stderr() { return ReadAwaitable{state->err}; }
+    WaitAwaitable wait() { return WaitAwaitable{*state}; }
+
+    int pid() const { return state->process.pid; }
+
+    friend Task<Process> spawn_process(UvScheduler& scheduler, std::vector<std::string> argv);
+
+private:
+    explicit Process(std::unique_ptr<State> state) : state(std::move(state)) {}
+
+    // Hands the state over to the close callbacks, which free it once every handle is closed
+    void detach() {
+        if (!state) {
+            return;
+        }
+        if (state->open_handles == 0) {
+            state.reset();
+            return;
+        }
+        auto* raw = state.release();
+        raw->detached = true;
+        close_pipe(raw->out);
+        close_pipe(raw->err);
+        if (raw->process_open) {
+            raw->process_open = false;
+            uv_close(reinterpret_cast<uv_handle_t*>(&raw->process), close_cb);
+        }
+    }
+
+    static void wake(UvScheduler* scheduler, std::coroutine_handle<>& waiter, Priority priority) {
+        if (waiter) {
+            scheduler->post(std::exchange(waiter, {}), priority);
+        }
+    }
+
+    static void handle_closed(State* state) {
+        if (--state->open_handles == 0 && state->detached) {
+            delete state;
+        }
+    }
+
+    static void close_cb(uv_handle_t* handle) {
+        handle_closed(static_cast<State*>(handle->data));
+    }
+
+    static void close_pipe(OutputPipe& pipe) {
+        if (pipe.open) {
+            pipe.open = false;
+            uv_close(reinterpret_cast<uv_handle_t*>(&pipe.pipe), [](uv_handle_t* handle) {
+                handle_closed(static_cast<OutputPipe*>(handle->data)->owner);
+            });
+        }
+    }
+
+    static void alloc_cb(uv_handle_t* handle, std::size_t, uv_buf_t* buf) {
+        auto* pipe = static_cast<OutputPipe*>(handle->data);
+        if (!pipe->reading) {
+            pipe->reading = PipeBufferPool::local().acquire();
+        }
+        *buf = uv_buf_init(reinterpret_cast<char*>(pipe->reading.get()), PipeBufferPool::buffer_size);
+    }
+
+    static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t*) {
+        auto* pipe = static_cast<OutputPipe*>(stream->data);
+        if (nread == 0) {
+            // EAGAIN: nothing was read and the buffer stays lent for the next read. Waking the
+            // reader now would resume it with no chunk, which it takes for the end of the stream.
+            return;
+        }
+        if (nread > 0) {
+            pipe->chunks.emplace_back(std::move(pipe->reading), static_cast<std::size_t>(nread));
+            if (pipe->chunks.size() >= max_queued_chunks) {
+                pipe->paused = true;
+                uv_read_stop(stream);
+            }
+        } else {
+            if (nread == UV_EOF) {
+                pipe->eof = true;
+            } else {
+                pipe->error = static_cast<int>(nread);
+            }
+            PipeBufferPool::local().release(std::move(pipe->reading));
+            close_pipe(*pipe);
+        }
+        wake(pipe->owner->scheduler, pipe->waiter, pipe->priority);
+    }
+
+    static void exit_cb(uv_process_t* process, std::int64_t exit_status, int term_signal) {
+        auto* state = static_cast<State*>(process->data);
+        state->status = ExitStatus{exit_status, term_signal};
+        state->exited = true;
+        state->process_open = false;
+        uv_close(reinterpret_cast<uv_handle_t*>(process), close_cb);
+        wake(state->scheduler, state->waiter, state->priority);
+    }
+
+    std::unique_ptr<State> state;
+};
+
+// Start argv[0] (looked up in PATH) with stdin closed and stdout/stderr piped back to the loop
+inline Task<Process> spawn_process(UvScheduler& scheduler, std::vector<std::string> argv) {
+    auto state = std::make_unique<Process::State>();
+    state->scheduler = &scheduler;
+    auto* loop = scheduler.get_loop();
+
+    for (auto* pipe : {&state->out, &state->err}) {
+        uv_pipe_init(loop, &pipe->pipe, 0);
+        pipe->pipe.data = pipe;
+        pipe->owner = state.get();
+    }
+    state->process.data = state.get();
+
+    std::vector<char*> args;
+    for (auto& arg : argv) {
+        args.push_back(arg.data());
+    }
+    args.push_back(nullptr);
+
+    uv_stdio_container_t stdio[3];
+    stdio[0].flags = UV_IGNORE;
+    stdio[1].flags = static_cast<uv_stdio_flags>(UV_CREATE_PIPE | UV_WRITABLE_PIPE);
+    stdio[1].data.stream = reinterpret_cast<uv_stream_t*>(&state->out.pipe);
+    stdio[2].flags = static_cast<uv_stdio_flags>(UV_CREATE_PIPE | UV_WRITABLE_PIPE);
+    stdio[2].data.stream = reinterpret_cast<uv_stream_t*>(&state->err.pipe);
+
+    uv_process_options_t options{};
+    options.file = args[0];
+    options.args = args.data();
+    options.exit_cb = Process::exit_cb;
+    options.stdio_count = 3;
+    options.stdio = stdio;
+
+    Process process(std::move(state));
+    int res = uv_spawn(loop, &process.state->process, &options);
+    if (res < 0) {
+        // ~Process closes the handles that uv_spawn initialised
+        throw std::system_error(-res, std::generic_category(), "uv_spawn " + argv[0]);
+    }
+
+    for (auto* pipe : {&process.state->out, &process.state->err}) {
+        uv_read_start(reinterpret_cast<uv_stream_t*>(&pipe->pipe), Process::alloc_cb, Process::read_cb);
+    }
+    co_return process;
+}
+
+template<typename Sched = Scheduler>
+Task<Process> spawn_process(std::vector<std::string> argv) {
+    static_assert(std::is_same_v<Sched, UvScheduler>, "spawn_process needs the libuv backend");
+    return spawn_process(static_cast<Sched&>(get_scheduler()), std::move(argv));
+}
+
+
+#endif //CATCH2TESTEXAMPLE_PROCESS_HPP
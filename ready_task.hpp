@@ -0,0 +1,156 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_READY_TASK_HPP
+#define CATCH2TESTEXAMPLE_READY_TASK_HPP
+
+#include "task.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// Either a result that is already known or a Task that produces it. Awaiting a ready value does
+// not suspend and involves no coroutine frame, so a function can return a cache hit directly and
+// only start a coroutine on a miss:
+//
+//     ValueOrTask<Row> get(Key key) {
+//         if (auto* row = cache.find(key)) return *row;
+//         return fetch(key);  // Task<Row>
+//     }
+template<typename T>
+class ValueOrTask {
+public:
+    ValueOrTask(T value) : state(std::in_place_index<0>, std::move(value)) {}
+    ValueOrTask(Task<T> task) : state(std::in_place_index<1>, std::move(task)) {}
+
+    bool ready() const { return state.index() == 0; }
+
+    bool await_ready() { return ready(); }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) {
+        return task_awaiter().await_suspend(awaiting);
+    }
+
+    T await_resume() {
+        if (ready()) {
+            return std::move(std::get<0>(state));
+        }
+        return task_awaiter().await_resume();
+    }
+
+private:
+    typename Task<T>::awaiter task_awaiter() { return typename Task<T>::awaiter{std::get<1>(state).get_handle()}; }
+
+    std::variant<T, Task<T>> state;
+};
+
+template<>
+class ValueOrTask<void> {
+public:
+    ValueOrTask() = default;
+    ValueOrTask(Task<void> task) : task(std::move(task)) {}
+
+    bool ready() const { return !task; }
+
+    bool await_ready() { return ready(); }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) {
+        return Task<void>::awaiter{task->get_handle()}.await_suspend(awaiting);
+    }
+
+    void await_resume() {
+        if (task) {
+            Task<void>::awaiter{task->get_handle()}.await_resume();
+        }
+    }
+
+private:
+    std::optional<Task<void>> task;
+};
+
+template<typename T>
+ValueOrTask<std::decay_t<T>> make_ready_task(T&& value) {
+    return ValueOrTask<std::decay_t<T>>(std::forward<T>(value));
+}
+
+inline ValueOrTask<void> make_ready_task() {
+    return {};
+}
+
+// Task that starts running as soon as it is called instead of when first awaited. If it finishes
+// without suspending, awaiting it does not suspend either. It must be awaited on the thread it
+// suspended on: the continuation is only attached once the awaiter gets to it.
+template<typename T = void>
+class EagerTask {
+public:
+    struct promise_type : Task<T>::promise_type {
+        EagerTask get_return_object() {
+            return EagerTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_never initial_suspend() { return {}; }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    EagerTask(EagerTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+    EagerTask& operator=(EagerTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    ~EagerTask() {
+        if (handle) handle.destroy();
+    }
+
+    EagerTask(const EagerTask&) = delete;
+    EagerTask& operator=(const EagerTask&) = delete;
+
+    bool done() const { return handle.done(); }
+
+    struct awaiter {
+        handle_type coro;
+
+        bool await_ready() { return coro.done(); }
+
+        // The task is already running; it resumes the awaiting coroutine when it finishes
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> awaiting) {
+            coro.promise().set_continuation(awaiting);
+        }
+
+        T await_resume() {
+            if (coro.promise().exception) {
+                std::rethrow_exception(coro.promise().exception);
+            }
+            if constexpr (!std::is_void_v<T>) {
+                return std::move(coro.promise().value);
+            }
+        }
+    };
+
+    awaiter operator co_await() {
+        return awaiter{handle};
+    }
+
+    handle_type get_handle() const { return handle; }
+
+private:
+    explicit EagerTask(handle_type h) : handle(h) {}
+
+    handle_type handle;
+};
+
+
+#endif //CATCH2TESTEXAMPLE_READY_TASK_HPP
@@ -6,16 +6,67 @@
 #define CATCH2TESTEXAMPLE_SCHEDULER_H
 
 #include "task.hpp"
+#include "uv_backend.hpp"
+#if defined(LAZYNC_IO_URING)
+#include "uring_backend.hpp"
+#endif
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
 #include <condition_variable>
 #include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <list>
 #include <queue>
+#include <utility>
 #include <uv.h>
 
-// Simple Scheduler for managing timed tasks
-class Scheduler {
+// Progress marker read by a watchdog on another thread (see watchdog.hpp). The loop stores the
+// frame address of each coroutine it resumes, or callback_tag once it is back in libuv callbacks,
+// with a step counter in the low bits so resuming the same frame twice still changes the value.
+// Coroutine frames are at least 16-byte aligned, which leaves those bits free.
+struct LoopHeartbeat {
+    static constexpr std::uintptr_t idle = 0;
+    static constexpr std::uintptr_t callback_tag = 0x10;
+    static constexpr std::uintptr_t step_mask = 0xF;
+
+    std::atomic<std::uintptr_t> value{idle};
+    std::uintptr_t step = 0;  // loop thread only
+
+    void beat(std::uintptr_t tag) {
+        value.store(tag | (++step & step_mask), std::memory_order_relaxed);
+    }
+
+    void set_idle() {
+        value.store(idle, std::memory_order_relaxed);
+    }
+
+    static void* coroutine(std::uintptr_t value) {
+        const auto tag = value & ~step_mask;
+        return tag == callback_tag ? nullptr : reinterpret_cast<void*>(tag);
+    }
+};
+
+// Simple Scheduler for managing timed tasks, on top of an event backend policy (see event_backend.hpp)
+template<typename Backend>
+class BasicScheduler {
 public:
-    using TimerHandle = uv_timer_t;
+    using Wakeup = typename Backend::Wakeup;
+    using IoRequest = typename Backend::IoRequest;
+    using Work = typename Backend::Work;
+
+    struct TimerHandle {
+        typename Backend::Timer timer;
+        std::coroutine_handle<> coro;
+        Priority priority = Priority::Normal;
+        BasicScheduler* owner = nullptr;
+    };
+
     struct TimedTask {
         std::chrono::steady_clock::time_point wake_time;
         std::coroutine_handle<> coro;
@@ -25,43 +76,102 @@ public:
         }
     };
 
-    Scheduler() {
-        uv_loop_init(&loop);
+    BasicScheduler() : backend(this, drain_cb) {}
+
+    ~BasicScheduler() {
+        for (auto& task : spawned) {
+            task.handle.destroy();
+        }
+    }
+
+    BasicScheduler(const BasicScheduler&) = delete;
+    BasicScheduler& operator=(const BasicScheduler&) = delete;
+
+    // Maximum time spent resuming ready coroutines before the loop gets to poll for I/O again
+    void set_time_slice(std::chrono::microseconds slice) { time_slice = slice; }
+
+    // Number of times a non-empty queue may be passed over for a higher priority one
+    // before it is served regardless of priority
+    void set_starvation_limit(std::size_t limit) { starvation_limit = limit; }
+
+    // Report each resume to a watchdog; nullptr turns reporting off again
+    void set_heartbeat(LoopHeartbeat* beat) { heartbeat = beat; }
+
+    void schedule_after(std::coroutine_handle<> coro, std::chrono::milliseconds delay, TimerHandle& timer_handle,
+                        Priority priority = Priority::Normal) {
+        timer_handle.coro = coro;
+        timer_handle.priority = priority;
+        timer_handle.owner = this;
+        timer_handle.timer.data = &timer_handle;
+        timer_handle.timer.callback = timer_cb;
+        backend.start_timer(timer_handle.timer, delay);
+    }
+
+    static void timer_cb(typename Backend::Timer& timer) {
+        auto* timer_handle = static_cast<TimerHandle*>(timer.data);
+        timer_handle->owner->post(timer_handle->coro, timer_handle->priority);
+    }
+
+    // Cross-thread wakeup; the callback runs on this scheduler's loop thread
+    void init_wakeup(Wakeup& wakeup, void (*callback)(Wakeup&), void* data) {
+        wakeup.data = data;
+        wakeup.callback = callback;
+        backend.init_wakeup(wakeup);
     }
 
-    ~Scheduler() {
-        uv_loop_close(&loop);
+    static void send(Wakeup& wakeup) {
+        Backend::send(wakeup);
     }
 
-    void schedule_after(std::coroutine_handle<> coro, std::chrono::milliseconds delay, uv_timer_t& timer_handle) {
-        uv_timer_init(&loop, &timer_handle);
-        timer_handle.data = coro.address();
-        int res = uv_timer_start(&timer_handle, timer_cb, delay.count(), 0);
-        assert(res == 0);
+    void close_wakeup(Wakeup& wakeup) {
+        backend.close_wakeup(wakeup);
     }
 
-    static void timer_cb(uv_timer_t *handle) {
-        std::coroutine_handle<> coro = std::coroutine_handle<>::from_address(handle->data);
-        coro.resume();
+    // Start a read or write; the request's callback runs on the loop thread
+    void submit_io(IoRequest& request) {
+        backend.submit(request);
     }
 
+    // Run work on a worker thread; the callback runs on the loop thread
+    void queue_work(Work& work) {
+        backend.queue_work(work);
+    }
+
+    // Queue a coroutine for resumption on the next pass over the ready queues
+    void post(std::coroutine_handle<> coro, Priority priority = Priority::Normal) {
+        ready[static_cast<std::size_t>(priority)].push_back(coro);
+        backend.start_draining();
+    }
+
+    // Start a task without waiting for it; the scheduler owns it until it completes, and destroys
+    // it as soon as it does. The first exception a spawned task throws is rethrown from run().
     template <class T>
-    T schedule(const Task<T>& task) {
-        uv_async_t async;
-        uv_async_init(&loop, &async, [](uv_async_t* async) {
-            auto thisHandle = std::coroutine_handle<>::from_address(async->data);
-            if (!thisHandle.done()) {
-                thisHandle.resume();
-            }
-            uv_close(reinterpret_cast<uv_handle_t*>(async), nullptr);
-        });
+    void spawn(Task<T> task, Priority priority = Priority::Normal) {
+        task.set_priority(priority);
+        auto handle = task.release();
+        auto& entry = spawned.emplace_front(this, handle, &handle.promise().exception);
+        entry.self = spawned.begin();
+        handle.promise().on_complete = on_spawned_complete;
+        handle.promise().on_complete_context = &entry;
+        post(handle, priority);
+    }
 
-        auto handle = task.get_handle();
-        async.data = handle.address();
+    // Run the loop until there is no more pending work
+    void run() {
+        backend.run();
+        if (spawned_exception) {
+            std::rethrow_exception(std::exchange(spawned_exception, nullptr));
+        }
+    }
 
-        uv_async_send(&async);
+    template <class T>
+    T schedule(const Task<T>& task) {
+        auto handle = task.get_handle();
+        if (!handle.done()) {
+            post(handle, handle.promise().priority);
+        }
 
-        uv_run(&loop, UV_RUN_DEFAULT);
+        run();
 
         if (handle.promise().exception) {
             std::rethrow_exception(handle.promise().exception);
@@ -71,31 +181,158 @@ public:
     }
 
     void schedule(const Task<void>& task) {
-        uv_async_t async;
-        uv_async_init(&loop, &async, [](uv_async_t* async) {
-            auto thisHandle = std::coroutine_handle<>::from_address(async->data);
-            if (!thisHandle.done()) {
-                thisHandle.resume();
-            }
-            uv_close(reinterpret_cast<uv_handle_t*>(async), nullptr);
-        });
+        auto handle = task.get_handle();
+        if (!handle.done()) {
+            post(handle, handle.promise().priority);
+        }
 
-        async.data = task.get_handle().address();
+        run();
 
-        uv_async_send(&async);
+        if (handle.promise().exception) {
+            std::rethrow_exception(handle.promise().exception);
+        }
+    }
 
-        uv_run(&loop, UV_RUN_DEFAULT);
+    // Underlying libuv loop, for facilities that are only implemented on top of libuv
+    uv_loop_t* get_loop() requires requires(Backend& b) { b.get_loop(); } {
+        return backend.get_loop();
     }
 
 private:
-    uv_loop_t loop;
+    static void drain_cb(void* self) {
+        static_cast<BasicScheduler*>(self)->drain_ready();
+    }
+
+    std::coroutine_handle<> pop_next() {
+        std::size_t pick = priority_levels;
+        for (std::size_t level = 0; level < priority_levels; ++level) {
+            if (ready[level].empty()) {
+                continue;
+            }
+            if (pick == priority_levels) {
+                pick = level;
+            } else if (skipped[level] >= starvation_limit) {
+                // Starvation protection: a lower level that has waited long enough goes first
+                pick = level;
+                break;
+            }
+        }
+        if (pick == priority_levels) {
+            return {};
+        }
+
+        for (std::size_t level = pick + 1; level < priority_levels; ++level) {
+            if (!ready[level].empty()) {
+                ++skipped[level];
+            }
+        }
+        skipped[pick] = 0;
+
+        auto coro = ready[pick].front();
+        ready[pick].pop_front();
+        return coro;
+    }
+
+    void drain_ready() {
+        const auto deadline = std::chrono::steady_clock::now() + time_slice;
+        while (auto coro = pop_next()) {
+            if (!coro.done()) {
+                if (heartbeat) {
+                    heartbeat->beat(reinterpret_cast<std::uintptr_t>(coro.address()));
+                }
+                coro.resume();
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+        if (heartbeat) {
+            heartbeat->beat(LoopHeartbeat::callback_tag);
+        }
+
+        if (std::all_of(ready.begin(), ready.end(), [](const auto& q) { return q.empty(); })) {
+            backend.stop_draining();
+        }
+    }
+
+    struct Spawned {
+        BasicScheduler* owner;
+        std::coroutine_handle<> handle;
+        std::exception_ptr* exception;
+        typename std::list<Spawned>::iterator self{};
+    };
+
+    // Runs from the spawned task's final suspend, where its frame may already be destroyed
+    static std::coroutine_handle<> on_spawned_complete(void* context) {
+        auto& entry = *static_cast<Spawned*>(context);
+        auto* owner = entry.owner;
+        if (*entry.exception && !owner->spawned_exception) {
+            owner->spawned_exception = *entry.exception;
+        }
+        entry.handle.destroy();
+        owner->spawned.erase(entry.self);
+        return std::noop_coroutine();
+    }
+
+    Backend backend;
+    std::array<std::deque<std::coroutine_handle<>>, priority_levels> ready;
+    std::array<std::size_t, priority_levels> skipped{};
+    std::chrono::microseconds time_slice{1000};
+    std::size_t starvation_limit = 16;
+    std::list<Spawned> spawned;
+    std::exception_ptr spawned_exception;
+    LoopHeartbeat* heartbeat = nullptr;
 };
 
-// Global scheduler
+// Scheduler on libuv, for facilities that need the libuv loop regardless of the default backend
+using UvScheduler = BasicScheduler<UvBackend>;
+
+#if defined(LAZYNC_IO_URING)
+using Scheduler = BasicScheduler<UringBackend>;
+#else
+using Scheduler = BasicScheduler<UvBackend>;
+#endif
+
+// Scheduler owned by the current thread, set by threads that run their own loop
+inline Scheduler*& current_scheduler() {
+    thread_local Scheduler* scheduler = nullptr;
+    return scheduler;
+}
+
+// Global scheduler, or the thread's own scheduler when running on a shard
 inline Scheduler& get_scheduler() {
+    if (auto* scheduler = current_scheduler()) {
+        return *scheduler;
+    }
     static Scheduler scheduler;
     return scheduler;
 }
 
+// Yield to the scheduler; the coroutine is requeued behind other ready work of its priority
+template<typename Sched>
+struct BasicRescheduleAwaitable {
+    Sched& scheduler;
+
+    bool await_ready() { return false; }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> coro) {
+        scheduler.post(coro, priority_of(coro));
+    }
+
+    void await_resume() {}
+};
+
+using RescheduleAwaitable = BasicRescheduleAwaitable<Scheduler>;
+
+inline RescheduleAwaitable reschedule() {
+    return {get_scheduler()};
+}
+
+template<typename Sched>
+BasicRescheduleAwaitable<Sched> reschedule(Sched& scheduler) {
+    return {scheduler};
+}
+
 
-#endif //CATCH2TESTEXAMPLE_SCHEDULER_H
\ No newline at end of file
+#endif //CATCH2TESTEXAMPLE_SCHEDULER_H
@@ -0,0 +1,326 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_SHARD_HPP
+#define CATCH2TESTEXAMPLE_SHARD_HPP
+
+#include "scheduler.hpp"
+#include "task.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+// Bounded lock-free single-producer single-consumer ring
+template<typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool try_push(const T& value) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == Capacity) {
+                return false;
+            }
+        }
+        slots_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pop everything that is currently queued, publishing the new head once for the whole batch
+    template<typename F>
+    std::size_t drain(F&& f) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        for (auto i = head; i != tail; ++i) {
+            f(slots_[i & (Capacity - 1)]);
+        }
+        head_.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_ = 0;  // producer's view of head_
+    std::array<T, Capacity> slots_{};
+};
+
+class ShardedScheduler;
+
+namespace shard_detail {
+    struct ThreadState {
+        ShardedScheduler* shards = nullptr;
+        std::size_t index = std::numeric_limits<std::size_t>::max();
+    };
+
+    inline ThreadState& this_thread() {
+        thread_local ThreadState state;
+        return state;
+    }
+}
+
+// Index of the shard the calling thread runs, no_shard outside of shard threads
+inline constexpr std::size_t no_shard = std::numeric_limits<std::size_t>::max();
+
+inline std::size_t current_shard() {
+    return shard_detail::this_thread().index;
+}
+
+// One Scheduler and event loop per thread. Coroutines hop between shards with co_await on_shard(i);
+// hops go through per (source, destination) SPSC mailboxes that the destination drains in batches.
+class ShardedScheduler {
+public:
+    static constexpr std::size_t mailbox_capacity = 1024;
+
+    explicit ShardedScheduler(std::size_t count = std::thread::hardware_concurrency(), bool pin_threads = true) {
+        if (count == 0) {
+            count = 1;
+        }
+        shards.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            shards.push_back(std::make_unique<Shard>(count));
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            shards[i]->thread = std::thread([this, i] { run_shard(i); });
+            if (pin_threads) {
+                pin(shards[i]->thread, i);
+            }
+        }
+
+        std::unique_lock lock(startup_mutex);
+        startup_cv.wait(lock, [&] { return started == shards.size(); });
+    }
+
+    ~ShardedScheduler() {
+        for (auto& shard : shards) {
+            shard->stopping.store(true, std::memory_order_release);
+            Scheduler::send(shard->wakeup);
+        }
+        for (auto& shard : shards) {
+            shard->thread.join();
+        }
+    }
+
+    ShardedScheduler(const ShardedScheduler&) = delete;
+    ShardedScheduler& operator=(const ShardedScheduler&) = delete;
+
+    std::size_t size() const { return shards.size(); }
+
+    // Stable key-to-shard routing
+    template<typename Key>
+    std::size_t shard_for(const Key& key) const {
+        return std::hash<Key>{}(key) % shards.size();
+    }
+
+    // Resume a coroutine on the given shard
+    void post(std::size_t target, std::coroutine_handle<> coro, Priority priority = Priority::Normal) {
+        auto& shard = *shards[target];
+        const auto source = current_shard();
+        const Message message{coro, priority};
+
+        if (source >= shards.size() || shard_detail::this_thread().shards != this
+            || !shard.mailboxes[source].try_push(message)) {
+            // Threads outside the set, and full mailboxes, fall back to the locked queue
+            std::lock_guard lock(shard.overflow_mutex);
+            shard.overflow.push_back(message);
+        }
+
+        if (!shard.wakeup_pending.exchange(true, std::memory_order_acq_rel)) {
+            Scheduler::send(shard.wakeup);
+        }
+    }
+
+    // Run a task on a shard and block the calling thread until it completes
+    template<typename T>
+    T run(std::size_t target, const Task<T>& task) {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool finished = false;
+
+        auto driver = drive(task, mutex, cv, finished);
+        driver.set_priority(task.priority());
+        post(target, driver.get_handle(), task.priority());
+
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return finished; });
+
+        auto handle = task.get_handle();
+        if (handle.promise().exception) {
+            std::rethrow_exception(handle.promise().exception);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(handle.promise().value);
+        }
+    }
+
+    struct OnShardAwaitable {
+        ShardedScheduler& shards;
+        std::size_t target;
+
+        bool await_ready() {
+            return current_shard() == target && shard_detail::this_thread().shards == &shards;
+        }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> coro) {
+            shards.post(target, coro, priority_of(coro));
+        }
+
+        void await_resume() {}
+    };
+
+    OnShardAwaitable on_shard(std::size_t target) {
+        return OnShardAwaitable{*this, target};
+    }
+
+    template<typename Key>
+    OnShardAwaitable on_shard_for(const Key& key) {
+        return OnShardAwaitable{*this, shard_for(key)};
+    }
+
+private:
+    struct Message {
+        std::coroutine_handle<> coro;
+        Priority priority = Priority::Normal;
+    };
+
+    struct Shard {
+        explicit Shard(std::size_t count) : mailboxes(count) {}
+
+        Scheduler scheduler;
+        Scheduler::Wakeup wakeup;
+        std::thread thread;
+        std::atomic<bool> wakeup_pending{false};
+        std::atomic<bool> stopping{false};
+        std::vector<SpscQueue<Message, mailbox_capacity>> mailboxes;  // indexed by source shard
+        std::mutex overflow_mutex;
+        std::vector<Message> overflow;
+    };
+
+    // Signals completion from inside await_suspend, after which the frame is never touched again
+    struct NotifyAwaitable {
+        std::mutex& mutex;
+        std::condition_variable& cv;
+        bool& finished;
+
+        bool await_ready() noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<>) noexcept {
+            std::lock_guard lock(mutex);
+            finished = true;
+            cv.notify_one();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    template<typename T>
+    static Task<void> drive(const Task<T>& task, std::mutex& mutex, std::condition_variable& cv, bool& finished) {
+        auto handle = task.get_handle();
+        if (!handle.done()) {
+            try {
+                co_await typename Task<T>::awaiter{handle};
+            } catch (...) {
+                // Left in the task's promise for run() to rethrow
+            }
+        }
+        co_await NotifyAwaitable{mutex, cv, finished};
+    }
+
+    // Shards are spread over the CPUs the process may run on, which need not be 0..n-1
+    static void pin(std::thread& thread, std::size_t index) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            return;
+        }
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty()) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[index % cpus.size()], &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+    }
+
+    static void wakeup_cb(Scheduler::Wakeup& wakeup) {
+        auto* self = static_cast<ShardedScheduler*>(wakeup.data);
+        self->drain(current_shard());
+    }
+
+    void drain(std::size_t index) {
+        auto& shard = *shards[index];
+        // An exchange rather than a store: the mailbox reads below must not move before it, or a
+        // producer that still sees the flag set would skip its wakeup while this drain misses its
+        // message
+        shard.wakeup_pending.exchange(false, std::memory_order_acq_rel);
+
+        auto& scheduler = shard.scheduler;
+        for (auto& mailbox : shard.mailboxes) {
+            mailbox.drain([&](const Message& message) { scheduler.post(message.coro, message.priority); });
+        }
+
+        std::vector<Message> overflow;
+        {
+            std::lock_guard lock(shard.overflow_mutex);
+            overflow.swap(shard.overflow);
+        }
+        for (const auto& message : overflow) {
+            scheduler.post(message.coro, message.priority);
+        }
+
+        if (shard.stopping.load(std::memory_order_acquire)) {
+            scheduler.close_wakeup(shard.wakeup);
+        }
+    }
+
+    void run_shard(std::size_t index) {
+        auto& shard = *shards[index];
+        current_scheduler() = &shard.scheduler;
+        shard_detail::this_thread() = {this, index};
+
+        shard.scheduler.init_wakeup(shard.wakeup, wakeup_cb, this);
+
+        {
+            std::lock_guard lock(startup_mutex);
+            ++started;
+        }
+        startup_cv.notify_one();
+
+        // The wakeup handle keeps the loop alive until the destructor asks it to close
+        shard.scheduler.run();
+
+        current_scheduler() = nullptr;
+        shard_detail::this_thread() = {};
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::mutex startup_mutex;
+    std::condition_variable startup_cv;
+    std::size_t started = 0;
+};
+
+
+#endif //CATCH2TESTEXAMPLE_SHARD_HPP
@@ -5,17 +5,156 @@
 #ifndef CATCH2TESTEXAMPLE_TASK_H
 #define CATCH2TESTEXAMPLE_TASK_H
 
+#include "latency_histogram.hpp"
+#include "task_registry.hpp"
+
+#include <chrono>
 #include <coroutine>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+// Priority class used by the Scheduler's ready queues, highest first
+enum class Priority : std::uint8_t {
+    High = 0,
+    Normal = 1,
+    Low = 2,
+};
+
+inline constexpr std::size_t priority_levels = 3;
+
+// Priority of the task owning a coroutine handle, Normal for non-Task coroutines
+template<typename Promise>
+Priority priority_of(std::coroutine_handle<Promise> coro) {
+    if constexpr (requires { coro.promise().priority; }) {
+        return coro.promise().priority;
+    } else {
+        return Priority::Normal;
+    }
+}
+
+// co_await named("db.get") tags the running task with a name that must have static storage
+// duration. From then on the task's wall and on-CPU time are tracked, and both are recorded into
+// the per-name histograms of latency_histogram.hpp when it completes.
+struct TaskName {
+    const char* name;
+};
+
+inline TaskName named(const char* name) {
+    return TaskName{name};
+}
+
+namespace task_detail {
+    inline std::uint64_t now_ns() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    template<typename A>
+    decltype(auto) get_awaiter(A&& awaitable) {
+        if constexpr (requires { std::forward<A>(awaitable).operator co_await(); }) {
+            return std::forward<A>(awaitable).operator co_await();
+        } else if constexpr (requires { operator co_await(std::forward<A>(awaitable)); }) {
+            return operator co_await(std::forward<A>(awaitable));
+        } else {
+            return std::forward<A>(awaitable);
+        }
+    }
+
+    // Name and timing state kept inline in every Task promise; unnamed tasks only pay for the
+    // name check around each suspension
+    class TaskTiming {
+    public:
+        template<typename Awaiter>
+        struct TimedAwaiter {
+            Awaiter awaiter;
+            TaskTiming* timing;
+            bool suspending = false;
+            [[no_unique_address]] task_registry_detail::AwaitingNote note{};
+
+            bool await_ready() { return awaiter.await_ready(); }
+
+            template<typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> coro) {
+                // The task may be resumed on another thread before await_suspend returns
+                suspending = true;
+                timing->suspended();
+                if constexpr (requires { coro.promise().note_awaiting(note, ""); }) {
+                    coro.promise().note_awaiting(note, typeid(Awaiter).name());
+                }
+                return awaiter.await_suspend(coro);
+            }
+
+            // A ready awaiter never suspended, so the task has been running all along
+            decltype(auto) await_resume() {
+                if (suspending) {
+                    note.clear();
+                    timing->resumed();
+                }
+                return awaiter.await_resume();
+            }
+        };
+
+        template<typename A>
+        auto await_transform(A&& awaitable) {
+            using Awaiter = decltype(get_awaiter(std::forward<A>(awaitable)));
+            return TimedAwaiter<Awaiter>{get_awaiter(std::forward<A>(awaitable)), this};
+        }
+
+        std::suspend_never await_transform(TaskName tag) {
+            if (!name) {
+                start_ns = resumed_ns = now_ns();
+            }
+            name = tag.name;
+            return {};
+        }
+
+        const char* task_name() const { return name; }
+
+    protected:
+        void suspended() {
+            if (name) {
+                cpu_ns += now_ns() - resumed_ns;
+            }
+        }
+
+        void resumed() {
+            if (name) {
+                resumed_ns = now_ns();
+            }
+        }
+
+        void finished() {
+            if (name) {
+                const auto now = now_ns();
+                cpu_ns += now - resumed_ns;
+                record_task_latency(name, now - start_ns, cpu_ns);
+            }
+        }
+
+    private:
+        const char* name = nullptr;
+        std::uint64_t start_ns = 0;
+        std::uint64_t resumed_ns = 0;
+        std::uint64_t cpu_ns = 0;
+    };
+}
 
 // Task implementation
 template<typename T = void>
 class Task {
 public:
-    struct promise_type {
+    struct promise_type : task_detail::TaskTiming, RegisteredFrame<promise_type> {
         T value;
         std::exception_ptr exception;
         std::coroutine_handle<> continuation;
+        Priority priority = Priority::Normal;
+        // Completion hook used instead of continuation when set; returns the coroutine to run next
+        std::coroutine_handle<> (*on_complete)(void*) = nullptr;
+        void* on_complete_context = nullptr;
 
         Task get_return_object() {
             return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
@@ -26,7 +165,12 @@ public:
         struct final_awaiter {
             bool await_ready() noexcept { return false; }
 
-            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+            // Templated so that promises derived from this one (EagerTask) can reuse it
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+                if (h.promise().on_complete) {
+                    return h.promise().on_complete(h.promise().on_complete_context);
+                }
                 if (h.promise().continuation) {
                     return h.promise().continuation;
                 }
@@ -36,7 +180,16 @@ public:
             void await_resume() noexcept {}
         };
 
-        final_awaiter final_suspend() noexcept { return {}; }
+        final_awaiter final_suspend() noexcept {
+            finished();
+            this->note_done();
+            return {};
+        }
+
+        void set_continuation(std::coroutine_handle<> coro) {
+            continuation = coro;
+            this->note_continuation(coro);
+        }
 
         void return_value(T val) {
             value = std::move(val);
@@ -70,6 +223,9 @@ public:
 
     bool done() const { return handle.done(); }
 
+    Priority priority() const { return handle.promise().priority; }
+    void set_priority(Priority p) { handle.promise().priority = p; }
+
     // Awaiter for co_await support
     struct awaiter {
         handle_type coro;
@@ -78,8 +234,13 @@ public:
             return coro.done();
         }
 
-        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
-            coro.promise().continuation = awaiting;
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) {
+            coro.promise().set_continuation(awaiting);
+            // Awaited tasks run at the priority of the awaiting task
+            if constexpr (requires { awaiting.promise().priority; }) {
+                coro.promise().priority = awaiting.promise().priority;
+            }
             return coro;
         }
 
@@ -97,6 +258,9 @@ public:
 
     handle_type get_handle() const { return handle; }
 
+    // Give up ownership of the coroutine frame
+    handle_type release() { return std::exchange(handle, {}); }
+
 private:
     handle_type handle;
 };
@@ -105,9 +269,13 @@ private:
 template<>
 class Task<void> {
 public:
-    struct promise_type {
+    struct promise_type : task_detail::TaskTiming, RegisteredFrame<promise_type> {
         std::exception_ptr exception;
         std::coroutine_handle<> continuation;
+        Priority priority = Priority::Normal;
+        // Completion hook used instead of continuation when set; returns the coroutine to run next
+        std::coroutine_handle<> (*on_complete)(void*) = nullptr;
+        void* on_complete_context = nullptr;
 
         Task get_return_object() {
             return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
@@ -118,7 +286,12 @@ public:
         struct final_awaiter {
             bool await_ready() noexcept { return false; }
 
-            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+            // Templated so that promises derived from this one (EagerTask) can reuse it
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+                if (h.promise().on_complete) {
+                    return h.promise().on_complete(h.promise().on_complete_context);
+                }
                 if (h.promise().continuation) {
                     return h.promise().continuation;
                 }
@@ -128,7 +301,16 @@ public:
             void await_resume() noexcept {}
         };
 
-        final_awaiter final_suspend() noexcept { return {}; }
+        final_awaiter final_suspend() noexcept {
+            finished();
+            this->note_done();
+            return {};
+        }
+
+        void set_continuation(std::coroutine_handle<> coro) {
+            continuation = coro;
+            this->note_continuation(coro);
+        }
 
         void return_void() {}
 
@@ -160,6 +342,9 @@ public:
 
     bool done() const { return handle.done(); }
 
+    Priority priority() const { return handle.promise().priority; }
+    void set_priority(Priority p) { handle.promise().priority = p; }
+
     // Awaiter for co_await support
     struct awaiter {
         handle_type coro;
@@ -168,8 +353,13 @@ public:
             return coro.done();
         }
 
-        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
-            coro.promise().continuation = awaiting;
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) {
+            coro.promise().set_continuation(awaiting);
+            // Awaited tasks run at the priority of the awaiting task
+            if constexpr (requires { awaiting.promise().priority; }) {
+                coro.promise().priority = awaiting.promise().priority;
+            }
             return coro;
         }
 
@@ -186,6 +376,9 @@ public:
 
     handle_type get_handle() const { return handle; }
 
+    // Give up ownership of the coroutine frame
+    handle_type release() { return std::exchange(handle, {}); }
+
 private:
     handle_type handle;
 };
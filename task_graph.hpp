@@ -0,0 +1,368 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_TASK_GRAPH_HPP
+#define CATCH2TESTEXAMPLE_TASK_GRAPH_HPP
+
+#include "scheduler.hpp"
+#include "task.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Typed handle to a node of a BasicTaskGraph, used as an input of later nodes and to take results
+template<typename T>
+struct NodeRef {
+    std::size_t index;
+};
+
+struct NodeTiming {
+    std::string name;
+    std::chrono::nanoseconds start;   // relative to the start of run()
+    std::chrono::nanoseconds finish;
+};
+
+struct CriticalPath {
+    std::vector<NodeTiming> nodes;    // from the first node to the last one to finish
+    std::chrono::nanoseconds length{0};
+};
+
+namespace task_graph_detail {
+    template<typename A>
+    struct task_result;
+
+    template<typename T>
+    struct task_result<Task<T>> {
+        using type = T;
+    };
+
+    template<typename A>
+    using task_result_t = typename task_result<A>::type;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct NodeBase {
+        explicit NodeBase(std::string name) : name(std::move(name)) {}
+        virtual ~NodeBase() = default;
+
+        // Runs the node and stores its result
+        virtual Task<void> execute() = 0;
+
+        std::string name;
+        std::vector<std::size_t> dependents;
+        std::size_t inputs = 0;           // edges into this node
+        std::size_t pending = 0;          // inputs that have not finished yet
+        std::size_t consumers = 0;        // data dependents that have not taken the result yet
+        std::optional<std::size_t> gate;  // the input whose completion started this node
+        std::exception_ptr exception;
+        bool finished = false;
+        bool skipped = false;
+        Clock::time_point start;
+        Clock::time_point finish;
+        std::optional<Task<void>> runner;
+    };
+
+    template<typename T>
+    struct ValueNode : NodeBase {
+        using NodeBase::NodeBase;
+
+        // The last consumer takes the result by move; earlier ones get copies
+        T consume() {
+            if (--consumers == 0) {
+                T value = std::move(*result);
+                result.reset();
+                return value;
+            }
+            if constexpr (std::is_copy_constructible_v<T>) {
+                return *result;
+            } else {
+                throw std::logic_error("TaskGraph: move-only result of " + name + " has several consumers");
+            }
+        }
+
+        std::optional<T> result;
+    };
+
+    template<>
+    struct ValueNode<void> : NodeBase {
+        using NodeBase::NodeBase;
+    };
+
+    template<typename T, typename F, typename... Inputs>
+    struct FnNode : ValueNode<T> {
+        FnNode(std::string name, F fn, std::tuple<ValueNode<Inputs>*...> inputs)
+            : ValueNode<T>(std::move(name)), fn(std::move(fn)), input_nodes(inputs) {}
+
+        Task<void> execute() override {
+            auto task = std::apply([this](auto*... in) { return fn(in->consume()...); }, input_nodes);
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+            } else {
+                this->result.emplace(co_await task);
+            }
+        }
+
+        F fn;
+        std::tuple<ValueNode<Inputs>*...> input_nodes;
+    };
+}
+
+// Dependency-driven executor for a DAG of tasks. Each node is a callable returning a Task; its
+// arguments are the results of its input nodes, and it starts as soon as the last input finishes.
+// A result with one consumer is moved into it; with several, all but the last consumer to start
+// receive copies. Results nobody consumes stay in the graph for take().
+//
+//     auto a = graph.add("a", [] -> Task<int> { ... });
+//     auto c = graph.add("c", [](int a, int b) -> Task<int> { ... }, a, b);
+//     co_await graph.run();
+//     int value = graph.take(c);
+//
+// If a node throws, nodes that depend on it are skipped and run() rethrows the first exception
+// once the nodes that are already running have finished.
+template<typename Sched = Scheduler>
+class BasicTaskGraph {
+public:
+    using Clock = task_graph_detail::Clock;
+
+    explicit BasicTaskGraph(Sched& scheduler = get_scheduler()) : scheduler(scheduler) {}
+
+    BasicTaskGraph(const BasicTaskGraph&) = delete;
+    BasicTaskGraph& operator=(const BasicTaskGraph&) = delete;
+
+    template<typename F, typename... Inputs>
+    auto add(std::string name, F fn, NodeRef<Inputs>... inputs) {
+        static_assert((!std::is_void_v<Inputs> && ...), "void nodes can only be ordered with precede()");
+        using Result = task_graph_detail::task_result_t<std::invoke_result_t<F&, Inputs...>>;
+        if (started) {
+            throw std::logic_error("TaskGraph: cannot change a graph that has run");
+        }
+        nodes.push_back(std::make_unique<task_graph_detail::FnNode<Result, F, Inputs...>>(
+            std::move(name), std::move(fn), std::make_tuple(&value_node(inputs)...)));
+        const std::size_t index = nodes.size() - 1;
+        (link(inputs.index, index, true), ...);
+        return NodeRef<Result>{index};
+    }
+
+    // Ordering-only edge: after does not start before before has finished
+    template<typename A, typename B>
+    void precede(NodeRef<A> before, NodeRef<B> after) {
+        link(before.index, after.index, false);
+    }
+
+    struct RunAwaitable {
+        BasicTaskGraph& graph;
+
+        bool await_ready() { return graph.nodes.empty(); }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> coro) {
+            graph.waiter = coro;
+            graph.priority = priority_of(coro);
+            graph.start();
+        }
+
+        void await_resume() {
+            if (graph.exception) {
+                std::rethrow_exception(graph.exception);
+            }
+        }
+    };
+
+    // Runs the whole graph once; throws std::logic_error if the precede() edges form a cycle
+    RunAwaitable run() {
+        if (started) {
+            throw std::logic_error("TaskGraph: already run");
+        }
+        check_acyclic();
+        started = true;
+        return RunAwaitable{*this};
+    }
+
+    template<typename T>
+        requires (!std::is_void_v<T>)
+    T take(NodeRef<T> ref) {
+        auto& node = value_node(ref);
+        if (!node.result) {
+            throw std::logic_error("TaskGraph: no result for " + node.name);
+        }
+        T value = std::move(*node.result);
+        node.result.reset();
+        return value;
+    }
+
+    // Chain of nodes that gated each other's start, ending at the last node to finish
+    CriticalPath critical_path() const {
+        CriticalPath path;
+        const NodeBase* last = nullptr;
+        for (auto& node : nodes) {
+            if (node->finished && (!last || node->finish > last->finish)) {
+                last = node.get();
+            }
+        }
+        for (auto* node = last; node; node = node->gate ? nodes[*node->gate].get() : nullptr) {
+            path.nodes.push_back(timing(*node));
+        }
+        std::reverse(path.nodes.begin(), path.nodes.end());
+        if (last) {
+            path.length = last->finish - run_start;
+        }
+        return path;
+    }
+
+    std::vector<NodeTiming> timings() const {
+        std::vector<NodeTiming> result;
+        for (auto& node : nodes) {
+            if (node->finished) {
+                result.push_back(timing(*node));
+            }
+        }
+        return result;
+    }
+
+private:
+    using NodeBase = task_graph_detail::NodeBase;
+
+    template<typename T>
+    task_graph_detail::ValueNode<T>& value_node(NodeRef<T> ref) {
+        check_index(ref.index);
+        return static_cast<task_graph_detail::ValueNode<T>&>(*nodes[ref.index]);
+    }
+
+    void check_index(std::size_t index) const {
+        if (index >= nodes.size()) {
+            throw std::out_of_range("TaskGraph: unknown node");
+        }
+    }
+
+    void link(std::size_t from, std::size_t to, bool data) {
+        if (started) {
+            throw std::logic_error("TaskGraph: cannot change a graph that has run");
+        }
+        check_index(from);
+        check_index(to);
+        nodes[from]->dependents.push_back(to);
+        ++nodes[to]->inputs;
+        if (data) {
+            ++nodes[from]->consumers;
+        }
+    }
+
+    void check_acyclic() const {
+        std::vector<std::size_t> pending(nodes.size());
+        std::vector<std::size_t> ready;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            pending[i] = nodes[i]->inputs;
+            if (pending[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        std::size_t visited = 0;
+        while (!ready.empty()) {
+            auto index = ready.back();
+            ready.pop_back();
+            ++visited;
+            for (auto dependent : nodes[index]->dependents) {
+                if (--pending[dependent] == 0) {
+                    ready.push_back(dependent);
+                }
+            }
+        }
+        if (visited != nodes.size()) {
+            throw std::logic_error("TaskGraph: dependency cycle");
+        }
+    }
+
+    void start() {
+        run_start = Clock::now();
+        remaining = nodes.size();
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i]->pending = nodes[i]->inputs;
+        }
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i]->pending == 0) {
+                launch(i);
+            }
+        }
+    }
+
+    void launch(std::size_t index) {
+        auto& node = *nodes[index];
+        node.runner.emplace(run_node(index));
+        scheduler.post(node.runner->get_handle(), priority);
+    }
+
+    Task<void> run_node(std::size_t index) {
+        auto& node = *nodes[index];
+        node.start = Clock::now();
+        try {
+            co_await node.execute();
+        } catch (...) {
+            node.exception = std::current_exception();
+        }
+        node.finish = Clock::now();
+        node.finished = true;
+
+        if (node.exception) {
+            if (!exception) {
+                exception = node.exception;
+            }
+            skip_dependents(node);
+        } else {
+            for (auto dependent : node.dependents) {
+                auto& next = *nodes[dependent];
+                if (!next.skipped && --next.pending == 0) {
+                    next.gate = index;
+                    launch(dependent);
+                }
+            }
+        }
+        node_done();
+    }
+
+    void skip_dependents(NodeBase& node) {
+        for (auto dependent : node.dependents) {
+            auto& next = *nodes[dependent];
+            if (!next.skipped) {
+                next.skipped = true;
+                skip_dependents(next);
+                node_done();
+            }
+        }
+    }
+
+    void node_done() {
+        if (--remaining == 0) {
+            scheduler.post(std::exchange(waiter, {}), priority);
+        }
+    }
+
+    NodeTiming timing(const NodeBase& node) const {
+        return NodeTiming{node.name, node.start - run_start, node.finish - run_start};
+    }
+
+    Sched& scheduler;
+    std::vector<std::unique_ptr<NodeBase>> nodes;
+    std::size_t remaining = 0;
+    bool started = false;
+    std::exception_ptr exception;
+    Clock::time_point run_start;
+    std::coroutine_handle<> waiter;
+    Priority priority = Priority::Normal;
+};
+
+using TaskGraph = BasicTaskGraph<>;
+
+
+#endif //CATCH2TESTEXAMPLE_TASK_GRAPH_HPP
@@ -0,0 +1,413 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_TASK_REGISTRY_HPP
+#define CATCH2TESTEXAMPLE_TASK_REGISTRY_HPP
+
+// Registry of live Task frames, compiled in with LAZYNC_TASK_REGISTRY. Every Task promise then
+// links itself into a per-thread intrusive list when its frame is created, unlinks when it is
+// destroyed, and notes what it awaits whenever it suspends; the rest only happens when somebody
+// asks for a dump. Without the flag RegisteredFrame
+// is an empty base and none of this exists.
+
+#if defined(LAZYNC_TASK_REGISTRY)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cxxabi.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// One frame of an async stack, as seen at the time of the dump
+struct TaskFrameInfo {
+    void* address = nullptr;
+    void* continuation = nullptr;           // frame resumed when this one finishes
+    const char* name = nullptr;             // from co_await named(...), nullptr if unnamed
+    std::size_t size = 0;                   // coroutine frame allocation in bytes
+    std::chrono::nanoseconds age{0};
+    const char* awaiting = nullptr;         // mangled type of the awaiter it is suspended on
+    bool done = false;                      // finished but not destroyed yet
+
+    std::string awaiting_type() const {
+        if (!awaiting) {
+            return {};
+        }
+        int status = 0;
+        std::unique_ptr<char, decltype(&free)> demangled(
+            abi::__cxa_demangle(awaiting, nullptr, nullptr, &status), &free);
+        return status == 0 ? std::string(demangled.get()) : std::string(awaiting);
+    }
+};
+
+// Innermost frame first, followed by the frames waiting on it
+using AsyncStack = std::vector<TaskFrameInfo>;
+
+struct LiveTaskStats {
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+};
+
+namespace task_registry_detail {
+    struct FrameList;
+
+    inline std::chrono::nanoseconds coarse_now() {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+    }
+
+    // Part of every registered promise. The links are guarded by the list's lock; everything a dump
+    // reports is published into the atomics by the frame itself, so a dump never reads the promise
+    // or the coroutine handle of a frame that another thread is running.
+    struct FrameNode {
+        FrameNode* prev = nullptr;
+        FrameNode* next = nullptr;
+        FrameList* list = nullptr;
+        void* address = nullptr;
+        std::size_t size = 0;                   // 0 if the allocation was elided
+        std::chrono::nanoseconds created{0};
+        std::atomic<void*> continuation{nullptr};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<const char*> awaiting{nullptr};
+        std::atomic<bool> done{false};
+    };
+
+    // Frames created on one thread. They may be destroyed on another, and dumps walk the list from
+    // yet another, so the links are behind a spin lock that is only contended in those cases.
+    struct FrameList {
+        std::atomic<bool> locked{false};
+        FrameNode head;
+
+        FrameList() {
+            head.prev = head.next = &head;
+        }
+
+        void lock() {
+            while (locked.exchange(true, std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() {
+            locked.store(false, std::memory_order_release);
+        }
+    };
+
+    // Lists are never destroyed: a list whose thread exited is handed to the next new thread, and
+    // the registry itself outlives every thread that may still touch it at exit
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<FrameList>> lists;
+        std::vector<FrameList*> unowned;
+
+        static Registry& instance() {
+            static auto* registry = new Registry;
+            return *registry;
+        }
+
+        FrameList* acquire() {
+            std::lock_guard lock(mutex);
+            if (!unowned.empty()) {
+                auto* list = unowned.back();
+                unowned.pop_back();
+                return list;
+            }
+            lists.push_back(std::make_unique<FrameList>());
+            return lists.back().get();
+        }
+
+        void release(FrameList* list) {
+            std::lock_guard lock(mutex);
+            unowned.push_back(list);
+        }
+    };
+
+    inline thread_local FrameList* current_list = nullptr;
+
+    inline FrameList& local_list() {
+        if (!current_list) [[unlikely]] {
+            struct Owner {
+                FrameList* list = Registry::instance().acquire();
+
+                ~Owner() {
+                    current_list = nullptr;
+                    Registry::instance().release(list);
+                }
+            };
+            thread_local Owner owner;
+            current_list = owner.list;
+        }
+        return *current_list;
+    }
+
+    // Allocation made by the promise's operator new, picked up by the promise constructor that runs
+    // right after it on the same thread. An elided frame never goes through operator new, so the
+    // constructor only trusts it if it is its own frame.
+    struct Allocation {
+        void* frame = nullptr;
+        std::size_t size = 0;
+    };
+
+    inline thread_local Allocation last_allocation;
+
+    // Lets an awaiter clear what its task is awaiting once it resumes
+    struct AwaitingNote {
+        std::atomic<const char*>* slot = nullptr;
+
+        void clear() {
+            if (slot) {
+                slot->store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+}
+
+// Base of the Task promises that keeps the frame in the registry: one link into the creating
+// thread's list and one unlink, each under an uncontended spin lock, plus a coarse clock read
+template<typename Promise>
+class RegisteredFrame : task_registry_detail::FrameNode {
+public:
+    static void* operator new(std::size_t size) {
+        void* frame = ::operator new(size);
+        task_registry_detail::last_allocation = {frame, size};
+        return frame;
+    }
+
+    static void operator delete(void* frame, std::size_t size) {
+        ::operator delete(frame, size);
+    }
+
+    RegisteredFrame() {
+        auto& promise = static_cast<Promise&>(*this);
+        address = std::coroutine_handle<Promise>::from_promise(promise).address();
+        const auto allocation = std::exchange(task_registry_detail::last_allocation, {});
+        size = allocation.frame == address ? allocation.size : 0;
+        created = task_registry_detail::coarse_now();
+
+        auto& local = task_registry_detail::local_list();
+        std::lock_guard lock(local);
+        list = &local;
+        prev = &local.head;
+        next = local.head.next;
+        next->prev = this;
+        local.head.next = this;
+    }
+
+    ~RegisteredFrame() {
+        std::lock_guard lock(*list);
+        prev->next = next;
+        next->prev = prev;
+    }
+
+    RegisteredFrame(const RegisteredFrame&) = delete;
+    RegisteredFrame& operator=(const RegisteredFrame&) = delete;
+
+    // Called by the running frame at every suspension, which is also when its name is published
+    void note_awaiting(task_registry_detail::AwaitingNote& note, const char* type) {
+        awaiting.store(type, std::memory_order_relaxed);
+        name.store(static_cast<Promise&>(*this).task_name(), std::memory_order_relaxed);
+        note.slot = &awaiting;
+    }
+
+    void note_continuation(std::coroutine_handle<> coro) {
+        continuation.store(coro.address(), std::memory_order_relaxed);
+    }
+
+    void note_done() {
+        done.store(true, std::memory_order_relaxed);
+    }
+};
+
+// Snapshot of all live Task frames grouped into async stacks. Frames on other threads keep running
+// while the lists are walked, so a stack can be torn if its frames move at that moment.
+inline std::vector<AsyncStack> live_task_stacks() {
+    auto& registry = task_registry_detail::Registry::instance();
+    std::vector<task_registry_detail::FrameList*> lists;
+    {
+        std::lock_guard lock(registry.mutex);
+        for (auto& list : registry.lists) {
+            lists.push_back(list.get());
+        }
+    }
+
+    const auto now = task_registry_detail::coarse_now();
+    std::vector<TaskFrameInfo> frames;
+    for (auto* list : lists) {
+        std::lock_guard lock(*list);
+        for (auto* node = list->head.next; node != &list->head; node = node->next) {
+            TaskFrameInfo info;
+            info.address = node->address;
+            info.continuation = node->continuation.load(std::memory_order_relaxed);
+            info.name = node->name.load(std::memory_order_relaxed);
+            info.size = node->size;
+            info.age = now - node->created;
+            info.awaiting = node->awaiting.load(std::memory_order_relaxed);
+            info.done = node->done.load(std::memory_order_relaxed);
+            frames.push_back(info);
+        }
+    }
+
+    std::unordered_map<void*, std::size_t> by_address;
+    std::unordered_set<void*> awaited;  // frames that a live frame resumes when it finishes
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        by_address.emplace(frames[i].address, i);
+        if (frames[i].continuation) {
+            awaited.insert(frames[i].continuation);
+        }
+    }
+
+    // Every stack starts at a frame that is not waiting on another live frame and follows the
+    // continuations outwards
+    std::vector<AsyncStack> stacks;
+    for (auto& frame : frames) {
+        if (awaited.contains(frame.address)) {
+            continue;
+        }
+        AsyncStack stack{frame};
+        for (auto it = by_address.find(frame.continuation);
+             it != by_address.end() && stack.size() <= frames.size();
+             it = by_address.find(frames[it->second].continuation)) {
+            stack.push_back(frames[it->second]);
+        }
+        stacks.push_back(std::move(stack));
+    }
+    // Oldest outermost frame first: long-lived stacks are the interesting ones
+    std::sort(stacks.begin(), stacks.end(), [](const AsyncStack& a, const AsyncStack& b) {
+        return a.back().age > b.back().age;
+    });
+    return stacks;
+}
+
+inline LiveTaskStats live_task_stats() {
+    auto& registry = task_registry_detail::Registry::instance();
+    std::lock_guard registry_lock(registry.mutex);
+    LiveTaskStats stats;
+    for (auto& list : registry.lists) {
+        std::lock_guard lock(*list);
+        for (auto* node = list->head.next; node != &list->head; node = node->next) {
+            ++stats.count;
+            stats.bytes += node->size;
+        }
+    }
+    return stats;
+}
+
+// Human-readable async backtraces of all live tasks
+inline std::string format_task_stacks() {
+    const auto stacks = live_task_stacks();
+    std::string out;
+    LiveTaskStats stats;
+    char line[256];
+    for (std::size_t s = 0; s < stacks.size(); ++s) {
+        std::snprintf(line, sizeof(line), "async stack %zu:\n", s + 1);
+        out += line;
+        for (std::size_t i = 0; i < stacks[s].size(); ++i) {
+            const auto& frame = stacks[s][i];
+            std::snprintf(line, sizeof(line), "  #%zu %p %s %zu bytes, age %.3f ms",
+                          i, frame.address, frame.name ? frame.name : "<unnamed>", frame.size,
+                          std::chrono::duration<double, std::milli>(frame.age).count());
+            out += line;
+            if (frame.done) {
+                out += ", finished";
+            } else if (frame.awaiting) {
+                out += ", awaiting " + frame.awaiting_type();
+            }
+            out += '\n';
+            ++stats.count;
+            stats.bytes += frame.size;
+        }
+    }
+    std::snprintf(line, sizeof(line), "%zu live tasks, %zu bytes\n", stats.count, stats.bytes);
+    out += line;
+    return out;
+}
+
+namespace task_registry_detail {
+    struct DumpSignal {
+        int pipe_fds[2] = {-1, -1};
+        std::atomic<int> output{STDERR_FILENO};
+
+        static DumpSignal& instance() {
+            static DumpSignal dump;
+            return dump;
+        }
+
+        // Formatting needs locks and allocation, so the handler only wakes a dumper thread
+        void start() {
+            if (pipe(pipe_fds) != 0) {
+                throw std::system_error(errno, std::generic_category(), "pipe");
+            }
+            std::thread([this] {
+                char byte;
+                while (read(pipe_fds[0], &byte, 1) > 0) {
+                    const auto text = format_task_stacks();
+                    const int fd = output.load();
+                    for (std::size_t written = 0; written < text.size();) {
+                        const auto n = write(fd, text.data() + written, text.size() - written);
+                        if (n <= 0) {
+                            break;
+                        }
+                        written += static_cast<std::size_t>(n);
+                    }
+                }
+            }).detach();
+        }
+    };
+}
+
+// Writes format_task_stacks() to fd whenever the process receives signal. Later calls redirect
+// the output and may add signals.
+inline void install_task_dump_signal(int fd = STDERR_FILENO, int signal = SIGUSR2) {
+    auto& dump = task_registry_detail::DumpSignal::instance();
+    static std::once_flag started;
+    std::call_once(started, [&dump] { dump.start(); });
+    dump.output.store(fd);
+
+    struct sigaction action{};
+    action.sa_handler = [](int) {
+        const char byte = 0;
+        [[maybe_unused]] auto n = write(task_registry_detail::DumpSignal::instance().pipe_fds[1], &byte, 1);
+    };
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(signal, &action, nullptr);
+}
+
+#else
+
+#include <coroutine>
+
+namespace task_registry_detail {
+    struct AwaitingNote {
+        void clear() {}
+    };
+}
+
+template<typename Promise>
+class RegisteredFrame {
+public:
+    void note_continuation(std::coroutine_handle<>) {}
+    void note_done() {}
+};
+
+#endif
+
+
+#endif //CATCH2TESTEXAMPLE_TASK_REGISTRY_HPP
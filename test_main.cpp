@@ -2,10 +2,32 @@
 #include <catch2/catch_all.hpp>
 
 #include <coroutine>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
-
+#include <memory>
+#include <numeric>
+#include <set>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "batcher.hpp"
+#include "directory_walker.hpp"
+#include "io.hpp"
+#include "ipc_channel.hpp"
+#include "latency_histogram.hpp"
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+#include "process.hpp"
+#include "ready_task.hpp"
+#include "shard.hpp"
+#include "task_graph.hpp"
+#include "uring_backend.hpp"
 #include "utils.hpp"
 #include "timer.hpp"
+#include "watchdog.hpp"
 
 Task<int> calculate_async(int x) {
     co_return x * 2 + 10;
@@ -504,3 +526,1259 @@ TEST_CASE("When all return values") {
     REQUIRE(std::get<0>(t) == 15);
     REQUIRE(std::get<1>(t) == 13);
 }
+
+Task<void> record_after_yield(std::vector<int>* order, int id) {
+    co_await reschedule();
+    order->push_back(id);
+}
+
+TEST_CASE("Scheduler: Ready queue runs higher priority first", "[scheduler][priority]") {
+    std::vector<int> order;
+
+    get_scheduler().spawn(record_after_yield(&order, 3), Priority::Low);
+    get_scheduler().spawn(record_after_yield(&order, 2), Priority::Normal);
+    get_scheduler().spawn(record_after_yield(&order, 1), Priority::High);
+    get_scheduler().run();
+
+    REQUIRE(order == std::vector<int>{1, 2, 3});
+}
+
+TEST_CASE("Scheduler: Priority is inherited by awaited tasks", "[scheduler][priority]") {
+    Priority inner = Priority::Normal;
+
+    auto task = [](Priority* seen) -> Task<void> {
+        auto child = []() -> Task<void> { co_return; }();
+        co_await child;
+        *seen = child.priority();
+    }(&inner);
+    task.set_priority(Priority::High);
+    get_scheduler().schedule(task);
+
+    REQUIRE(inner == Priority::High);
+}
+
+TEST_CASE("Scheduler: Starvation protection serves low priority work", "[scheduler][priority]") {
+    int high_steps = 0;
+    bool low_done = false;
+    int high_steps_when_low_ran = -1;
+
+    auto busy_high = [](int* steps, bool* stop) -> Task<void> {
+        while (!*stop) {
+            ++*steps;
+            co_await reschedule();
+        }
+    };
+    auto low = [](bool* done, int* steps, int* seen) -> Task<void> {
+        co_await reschedule();
+        *done = true;
+        *seen = *steps;
+    };
+
+    get_scheduler().set_starvation_limit(4);
+    get_scheduler().spawn(busy_high(&high_steps, &low_done), Priority::High);
+    get_scheduler().spawn(low(&low_done, &high_steps, &high_steps_when_low_ran), Priority::Low);
+    get_scheduler().run();
+    get_scheduler().set_starvation_limit(16);
+
+    REQUIRE(low_done);
+    REQUIRE(high_steps_when_low_ran > 0);
+    REQUIRE(high_steps_when_low_ran <= 8);
+}
+
+TEST_CASE("Scheduler: A long ready queue yields to due timers once the time slice runs out", "[scheduler][slice]") {
+    constexpr int max_steps = 2000;
+    int steps = 0;
+    bool timer_fired = false;
+    int steps_when_timer_fired = -1;
+
+    // Every step keeps the ready queue non-empty and costs about 100 us, so only the time slice
+    // lets the loop get to its timers before all steps are done
+    auto busy = [](int* steps, bool* stop) -> Task<void> {
+        while (!*stop && *steps < max_steps) {
+            ++*steps;
+            const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(100);
+            while (std::chrono::steady_clock::now() < until) {
+            }
+            co_await reschedule();
+        }
+    };
+    auto timer = [](bool* fired, int* steps, int* seen) -> Task<void> {
+        co_await sleep_ms(1);
+        *fired = true;
+        *seen = *steps;
+    };
+
+    get_scheduler().set_time_slice(std::chrono::microseconds(500));
+    get_scheduler().spawn(timer(&timer_fired, &steps, &steps_when_timer_fired));
+    get_scheduler().spawn(busy(&steps, &timer_fired));
+    get_scheduler().run();
+    get_scheduler().set_time_slice(std::chrono::microseconds(1000));
+
+    REQUIRE(timer_fired);
+    REQUIRE(steps_when_timer_fired > 0);
+    REQUIRE(steps_when_timer_fired < max_steps / 10);
+}
+
+TEST_CASE("Scheduler: Spawned tasks are destroyed as soon as they complete", "[scheduler]") {
+    auto token = std::make_shared<int>(0);
+    std::weak_ptr<int> watch = token;
+    bool destroyed_while_running = false;
+
+    auto holder = [](std::shared_ptr<int>) -> Task<void> { co_return; };
+    auto observer = [](std::weak_ptr<int>* watch, bool* destroyed) -> Task<void> {
+        co_await reschedule();
+        co_await reschedule();
+        *destroyed = watch->expired();
+    };
+    get_scheduler().spawn(holder(std::move(token)));
+    get_scheduler().spawn(observer(&watch, &destroyed_while_running));
+    get_scheduler().run();
+
+    REQUIRE(destroyed_while_running);
+}
+
+TEST_CASE("Scheduler: Exceptions from spawned tasks are rethrown from run", "[scheduler]") {
+    bool sibling_done = false;
+    auto failing = []() -> Task<void> {
+        co_await reschedule();
+        throw std::runtime_error("spawned failure");
+    };
+    auto sibling = [](bool* done) -> Task<void> {
+        co_await sleep_ms(1);
+        *done = true;
+    };
+    get_scheduler().spawn(failing());
+    get_scheduler().spawn(sibling(&sibling_done));
+
+    REQUIRE_THROWS_WITH(get_scheduler().run(), "spawned failure");
+    REQUIRE(sibling_done);
+    REQUIRE_NOTHROW(get_scheduler().run());
+}
+
+Task<int> hop_between_shards(ShardedScheduler* shards, std::vector<std::size_t>* visited) {
+    visited->push_back(current_shard());
+    co_await shards->on_shard(2);
+    visited->push_back(current_shard());
+    co_await sleep_ms(10);
+    co_await shards->on_shard(1);
+    visited->push_back(current_shard());
+    co_return 7;
+}
+
+TEST_CASE("ShardedScheduler: co_await on_shard hops between shard threads", "[shard]") {
+    ShardedScheduler shards(4);
+    REQUIRE(shards.size() == 4);
+
+    std::vector<std::size_t> visited;
+    auto task = hop_between_shards(&shards, &visited);
+    REQUIRE(shards.run(0, task) == 7);
+    REQUIRE(visited == std::vector<std::size_t>{0, 2, 1});
+    REQUIRE(current_shard() == no_shard);
+}
+
+TEST_CASE("ShardedScheduler: Exceptions propagate to the caller of run", "[shard]") {
+    ShardedScheduler shards(2);
+
+    auto task = throwing_task();
+    REQUIRE_THROWS_WITH(shards.run(1, task), "Oops!");
+}
+
+TEST_CASE("ShardedScheduler: Key routing is stable and in range", "[shard]") {
+    ShardedScheduler shards(3, false);
+
+    for (int key = 0; key < 100; ++key) {
+        REQUIRE(shards.shard_for(key) < shards.size());
+        REQUIRE(shards.shard_for(key) == shards.shard_for(key));
+    }
+
+    auto task = [](ShardedScheduler* shards) -> Task<bool> {
+        const std::string key = "user:42";
+        co_await shards->on_shard_for(key);
+        co_return current_shard() == shards->shard_for(key);
+    }(&shards);
+    REQUIRE(shards.run(0, task));
+}
+
+TEST_CASE("ShardedScheduler: Many concurrent hops are all delivered", "[shard]") {
+    ShardedScheduler shards(4, false);
+    std::atomic<int> arrivals{0};
+
+    auto ping_pong = [](ShardedScheduler* shards, std::atomic<int>* arrivals, std::size_t start) -> Task<void> {
+        for (std::size_t i = 0; i < 500; ++i) {
+            co_await shards->on_shard((start + i) % shards->size());
+            arrivals->fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    auto task = [](ShardedScheduler* shards, std::atomic<int>* arrivals, auto ping_pong) -> Task<void> {
+        co_await when_all(ping_pong(shards, arrivals, 0), ping_pong(shards, arrivals, 1),
+                          ping_pong(shards, arrivals, 2), ping_pong(shards, arrivals, 3));
+    }(&shards, &arrivals, ping_pong);
+    shards.run(0, task);
+
+    REQUIRE(arrivals.load() == 2000);
+}
+
+TEMPLATE_TEST_CASE("Backend: Timers fire after their delay", "[backend]", UvBackend, UringBackend) {
+    BasicScheduler<TestType> scheduler;
+    auto start = std::chrono::steady_clock::now();
+
+    auto task = [](BasicScheduler<TestType>* s) -> Task<void> {
+        co_await when_all(sleep_ms(*s, 50), sleep_ms(*s, 100));
+    }(&scheduler);
+    scheduler.schedule(task);
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    REQUIRE(duration.count() >= 95);
+    REQUIRE(duration.count() < 150);
+}
+
+template<typename Sched>
+Task<void> record_after_sleep(Sched* scheduler, std::vector<int>* order, int id, int delay) {
+    co_await sleep_ms(*scheduler, delay);
+    order->push_back(id);
+}
+
+TEMPLATE_TEST_CASE("Backend: Timers that expire together resume in start order", "[backend]", UvBackend, UringBackend) {
+    BasicScheduler<TestType> scheduler;
+    std::vector<int> order;
+
+    scheduler.spawn(record_after_sleep(&scheduler, &order, 1, 5));
+    scheduler.spawn(record_after_sleep(&scheduler, &order, 2, 5));
+    scheduler.spawn(record_after_sleep(&scheduler, &order, 3, 5));
+    scheduler.spawn(record_after_sleep(&scheduler, &order, 4, 6));
+    scheduler.run();
+
+    REQUIRE(order == std::vector<int>{1, 2, 3, 4});
+}
+
+TEMPLATE_TEST_CASE("Backend: File write then read", "[backend][io]", UvBackend, UringBackend) {
+    BasicScheduler<TestType> scheduler;
+    char path[] = "/tmp/lazync_io_XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    unlink(path);
+
+    auto task = [](BasicScheduler<TestType>* s, int fd) -> Task<std::string> {
+        const std::string text = "hello from the event backend";
+        auto written = co_await async_write(*s, fd, std::as_bytes(std::span(text)), 0);
+        REQUIRE(written == text.size());
+
+        std::string back(text.size(), '\0');
+        auto read = co_await async_read(*s, fd, std::as_writable_bytes(std::span(back)), 0);
+        back.resize(read);
+        co_return back;
+    }(&scheduler, fd);
+
+    REQUIRE(scheduler.schedule(task) == "hello from the event backend");
+    close(fd);
+}
+
+TEMPLATE_TEST_CASE("Backend: Read errors are thrown", "[backend][io]", UvBackend, UringBackend) {
+    BasicScheduler<TestType> scheduler;
+
+    auto task = [](BasicScheduler<TestType>* s) -> Task<std::size_t> {
+        std::byte buffer[16];
+        co_return co_await async_read(*s, -1, std::span(buffer));
+    }(&scheduler);
+
+    REQUIRE_THROWS_AS(scheduler.schedule(task), std::system_error);
+}
+
+TEMPLATE_TEST_CASE("Backend: Wakeups from another thread", "[backend]", UvBackend, UringBackend) {
+    using Sched = BasicScheduler<TestType>;
+    Sched scheduler;
+    typename Sched::Wakeup wakeup;
+
+    struct Context {
+        Sched* scheduler;
+        std::atomic<int> received{0};
+    } context{&scheduler};
+
+    scheduler.init_wakeup(wakeup, [](typename Sched::Wakeup& w) {
+        auto* ctx = static_cast<Context*>(w.data);
+        if (++ctx->received == 1) {
+            ctx->scheduler->close_wakeup(w);
+        }
+    }, &context);
+
+    std::thread sender([&] { Sched::send(wakeup); });
+    scheduler.run();
+    sender.join();
+
+    REQUIRE(context.received == 1);
+}
+
+TEST_CASE("Offload: Runs on a worker thread and resumes on the loop thread", "[offload]") {
+    auto task = []() -> Task<bool> {
+        const auto loop_thread = std::this_thread::get_id();
+        auto worker_thread = co_await offload([] { return std::this_thread::get_id(); });
+        co_return worker_thread != loop_thread && std::this_thread::get_id() == loop_thread;
+    }();
+    REQUIRE(get_scheduler().schedule(task));
+}
+
+TEST_CASE("Offload: Exceptions are rethrown at the co_await", "[offload]") {
+    auto task = []() -> Task<void> {
+        co_await offload([] { throw std::runtime_error("worker failed"); });
+    }();
+    REQUIRE_THROWS_WITH(get_scheduler().schedule(task), "worker failed");
+}
+
+TEST_CASE("when_all: Runtime number of tasks", "[when_all]") {
+    auto task = []() -> Task<std::vector<int>> {
+        std::vector<Task<int>> tasks;
+        for (int i = 0; i < 10; ++i) {
+            tasks.push_back(async_add(i, i));
+        }
+        co_return co_await when_all(std::move(tasks));
+    }();
+
+    auto results = get_scheduler().schedule(task);
+    REQUIRE(results.size() == 10);
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(results[i] == 2 * i);
+    }
+}
+
+TEST_CASE("Parallel: async_transform preserves order", "[parallel]") {
+    std::vector<int> input(10'000);
+    std::iota(input.begin(), input.end(), 0);
+
+    auto task = async_transform(input, [](int x) { return x * 3; }, ParallelOptions{.chunk_size = 333, .max_parallel = 3});
+    auto output = get_scheduler().schedule(task);
+
+    REQUIRE(output.size() == input.size());
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        REQUIRE(output[i] == input[i] * 3);
+    }
+}
+
+TEST_CASE("Parallel: async_transform keeps every result of a predicate", "[parallel]") {
+    std::vector<int> input(10'000);
+    std::iota(input.begin(), input.end(), 0);
+
+    // Chunk boundaries that fall inside 64-bit words, so a packed std::vector<bool> would have
+    // workers writing to the same words
+    auto task = async_transform(input, [](int x) { return x % 3 == 0; }, ParallelOptions{.chunk_size = 37, .max_parallel = 4});
+    const std::vector<bool> output = get_scheduler().schedule(task);
+
+    std::vector<bool> expected(input.size());
+    std::transform(input.begin(), input.end(), expected.begin(), [](int x) { return x % 3 == 0; });
+    REQUIRE(output == expected);
+}
+
+TEST_CASE("Parallel: async_reduce matches std::accumulate", "[parallel]") {
+    std::vector<long> input(100'001);
+    std::iota(input.begin(), input.end(), 1);
+
+    auto task = async_reduce(input, 10L, std::plus<>{});
+    REQUIRE(get_scheduler().schedule(task) == std::accumulate(input.begin(), input.end(), 10L));
+
+    std::vector<long> empty;
+    auto empty_task = async_reduce(empty, 7L, std::plus<>{});
+    REQUIRE(get_scheduler().schedule(empty_task) == 7);
+}
+
+TEST_CASE("Parallel: async_for_each bounds the number of chunks in flight", "[parallel]") {
+    std::vector<int> input(64, 1);
+    std::atomic<int> in_flight{0};
+    std::atomic<int> peak{0};
+    std::atomic<int> sum{0};
+
+    auto task = async_for_each(input, [&](int x) {
+        auto now = ++in_flight;
+        auto seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        sum += x;
+        --in_flight;
+    }, ParallelOptions{.chunk_size = 1, .max_parallel = 2});
+    get_scheduler().schedule(task);
+
+    REQUIRE(sum == 64);
+    REQUIRE(peak <= 2);
+}
+
+TEST_CASE("Parallel: Exceptions from a chunk propagate", "[parallel]") {
+    std::vector<int> input(100, 0);
+    auto task = async_for_each(input, [](int) { throw std::runtime_error("bad element"); });
+    REQUIRE_THROWS_WITH(get_scheduler().schedule(task), "bad element");
+}
+
+Task<std::vector<int>> square_batch(std::vector<std::vector<int>>* seen, std::vector<int> requests) {
+    seen->push_back(requests);
+    std::vector<int> responses;
+    for (int r : requests) {
+        responses.push_back(r * r);
+    }
+    co_return responses;
+}
+
+Task<int> submit_one(Batcher<int, int>* batcher, int value) {
+    co_return co_await batcher->submit(value);
+}
+
+TEST_CASE("Batcher: Concurrent submits are coalesced into one batch", "[batcher]") {
+    std::vector<std::vector<int>> seen;
+    Batcher<int, int> batcher([&](std::vector<int> r) { return square_batch(&seen, std::move(r)); });
+
+    auto task = [](Batcher<int, int>* batcher) -> Task<std::vector<int>> {
+        std::vector<Task<int>> calls;
+        for (int i = 0; i < 10; ++i) {
+            calls.push_back(submit_one(batcher, i));
+        }
+        co_return co_await when_all(std::move(calls));
+    }(&batcher);
+
+    auto results = get_scheduler().schedule(task);
+    REQUIRE(batcher.batches() == 1);
+    REQUIRE(seen.size() == 1);
+    REQUIRE(seen[0].size() == 10);
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(results[i] == i * i);
+    }
+}
+
+TEST_CASE("Batcher: Size limit splits batches", "[batcher]") {
+    std::vector<std::vector<int>> seen;
+    Batcher<int, int> batcher([&](std::vector<int> r) { return square_batch(&seen, std::move(r)); },
+                              {.max_batch = 4, .window = std::chrono::milliseconds(50)});
+
+    std::chrono::milliseconds duration{};
+    auto task = [](Batcher<int, int>* batcher, std::chrono::milliseconds* duration) -> Task<std::vector<int>> {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Task<int>> calls;
+        for (int i = 0; i < 8; ++i) {
+            calls.push_back(submit_one(batcher, i));
+        }
+        auto results = co_await when_all(std::move(calls));
+        *duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        co_return results;
+    }(&batcher, &duration);
+    auto results = get_scheduler().schedule(task);
+
+    REQUIRE(batcher.batches() == 2);
+    REQUIRE(seen == std::vector<std::vector<int>>{{0, 1, 2, 3}, {4, 5, 6, 7}});
+    REQUIRE(results[7] == 49);
+    // Full batches go out without waiting for the window
+    REQUIRE(duration.count() < 40);
+}
+
+TEST_CASE("Batcher: Window collects submits that arrive over time", "[batcher]") {
+    std::vector<std::vector<int>> seen;
+    Batcher<int, int> batcher([&](std::vector<int> r) { return square_batch(&seen, std::move(r)); },
+                              {.max_batch = 64, .window = std::chrono::milliseconds(40)});
+
+    auto delayed = [](Batcher<int, int>* batcher, int delay, int value) -> Task<int> {
+        co_await sleep_ms(delay);
+        co_return co_await batcher->submit(value);
+    };
+    auto task = [](Batcher<int, int>* batcher, auto delayed) -> Task<void> {
+        co_await when_all(delayed(batcher, 0, 1), delayed(batcher, 10, 2), delayed(batcher, 20, 3),
+                          delayed(batcher, 80, 4));
+    }(&batcher, delayed);
+    get_scheduler().schedule(task);
+
+    REQUIRE(seen == std::vector<std::vector<int>>{{1, 2, 3}, {4}});
+}
+
+TEST_CASE("Batcher: Batch failures reach every waiter", "[batcher]") {
+    Batcher<int, int> batcher([](std::vector<int>) -> Task<std::vector<int>> {
+        throw std::runtime_error("backend down");
+        co_return std::vector<int>{};
+    });
+
+    auto task = [](Batcher<int, int>* batcher) -> Task<int> {
+        int failures = 0;
+        for (int i = 0; i < 3; ++i) {
+            try {
+                co_await batcher->submit(i);
+            } catch (const std::runtime_error&) {
+                ++failures;
+            }
+        }
+        co_return failures;
+    }(&batcher);
+    REQUIRE(get_scheduler().schedule(task) == 3);
+}
+
+Task<std::string> read_all(Process::ReadAwaitable (Process::*read)(), Process* process) {
+    std::string text;
+    while (auto chunk = co_await (process->*read)()) {
+        text += chunk->text();
+    }
+    co_return text;
+}
+
+TEST_CASE("Process: Streams stdout and reports the exit status", "[process]") {
+    UvScheduler scheduler;
+
+    auto task = [](UvScheduler* scheduler) -> Task<std::tuple<std::string, std::string, std::int64_t>> {
+        std::vector<std::string> argv{"sh", "-c", "echo out; echo err 1>&2; exit 3"};
+        auto process = co_await spawn_process(*scheduler, std::move(argv));
+        REQUIRE(process.pid() > 0);
+        auto out = co_await read_all(&Process::read_stdout, &process);
+        auto err = co_await read_all(&Process::read_stderr, &process);
+        auto status = co_await process.wait();
+        co_return std::make_tuple(out, err, status.exit_status);
+    }(&scheduler);
+
+    auto [out, err, status] = scheduler.schedule(task);
+    REQUIRE(out == "out\n");
+    REQUIRE(err == "err\n");
+    REQUIRE(status == 3);
+}
+
+TEST_CASE("Process: Large output is read in pooled chunks", "[process]") {
+    UvScheduler scheduler;
+
+    auto task = [](UvScheduler* scheduler) -> Task<std::size_t> {
+        std::vector<std::string> argv{"head", "-c", "1000000", "/dev/zero"};
+        auto process = co_await spawn_process(*scheduler, std::move(argv));
+        std::size_t total = 0;
+        while (auto chunk = co_await process.read_stdout()) {
+            total += chunk->bytes().size();
+        }
+        co_await process.wait();
+        co_return total;
+    }(&scheduler);
+
+    REQUIRE(scheduler.schedule(task) == 1'000'000);
+    REQUIRE(PipeBufferPool::local().free_count() > 0);
+    REQUIRE(PipeBufferPool::local().free_count() <= Process::max_queued_chunks + 2);
+}
+
+TEST_CASE("Process: Missing executables throw", "[process]") {
+    UvScheduler scheduler;
+
+    auto task = [](UvScheduler* scheduler) -> Task<void> {
+        std::vector<std::string> argv{"/nonexistent/lazync-test-binary"};
+        co_await spawn_process(*scheduler, std::move(argv));
+    }(&scheduler);
+
+    REQUIRE_THROWS_AS(scheduler.schedule(task), std::system_error);
+}
+
+TEST_CASE("Process: Many concurrent children", "[process]") {
+    UvScheduler scheduler;
+
+    auto child = [](UvScheduler* scheduler, int i) -> Task<std::string> {
+        std::vector<std::string> argv{"echo", std::to_string(i)};
+        auto process = co_await spawn_process(*scheduler, std::move(argv));
+        auto out = co_await read_all(&Process::read_stdout, &process);
+        co_await process.wait();
+        co_return out;
+    };
+    auto task = [](UvScheduler* scheduler, auto child) -> Task<std::vector<std::string>> {
+        std::vector<Task<std::string>> children;
+        for (int i = 0; i < 20; ++i) {
+            children.push_back(child(scheduler, i));
+        }
+        co_return co_await when_all(std::move(children));
+    }(&scheduler, child);
+
+    auto outputs = scheduler.schedule(task);
+    for (int i = 0; i < 20; ++i) {
+        REQUIRE(outputs[i] == std::to_string(i) + "\n");
+    }
+}
+
+std::string make_temp_file(std::size_t size) {
+    char path[] = "/tmp/lazync_map_XXXXXX";
+    int fd = mkstemp(path);
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>('a' + i % 26);
+    }
+    REQUIRE(write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    close(fd);
+    return path;
+}
+
+TEST_CASE("MappedChunks: Chunks are zero-copy views of the whole file", "[mapped]") {
+    const std::size_t size = 3 * 1024 * 1024 + 123;
+    auto path = make_temp_file(size);
+
+    auto task = [](std::string path) -> Task<bool> {
+        auto chunks = co_await mapped_chunks(path, 64 * 1024, 4);
+        const auto* base = chunks.file().bytes().data();
+        std::size_t offset = 0;
+        bool ok = true;
+        while (auto chunk = co_await chunks.next()) {
+            ok = ok && chunk->data() == base + offset;
+            ok = ok && chunk->size() == std::min<std::size_t>(64 * 1024, chunks.file().size() - offset);
+            ok = ok && static_cast<char>((*chunk)[0]) == static_cast<char>('a' + offset % 26);
+            offset += chunk->size();
+            ok = ok && chunks.prefaulted() >= offset;
+        }
+        co_return ok && offset == chunks.file().size();
+    }(path);
+
+    REQUIRE(get_scheduler().schedule(task));
+    unlink(path.c_str());
+}
+
+TEST_CASE("MappedChunks: Empty and missing files", "[mapped]") {
+    auto path = make_temp_file(0);
+
+    auto empty = [](std::string path) -> Task<bool> {
+        auto chunks = co_await mapped_chunks(path, 4096);
+        co_return !(co_await chunks.next()).has_value();
+    }(path);
+    REQUIRE(get_scheduler().schedule(empty));
+    unlink(path.c_str());
+
+    auto missing = []() -> Task<void> {
+        co_await mapped_chunks("/nonexistent/lazync-mapped-file", 4096);
+    }();
+    REQUIRE_THROWS_AS(get_scheduler().schedule(missing), std::system_error);
+}
+
+TEST_CASE("MappedChunks: Dropping a reader mid-file is safe", "[mapped]") {
+    auto path = make_temp_file(8 * 1024 * 1024);
+
+    auto task = [](std::string path) -> Task<std::size_t> {
+        auto chunks = co_await mapped_chunks(path, 1024 * 1024, 2);
+        auto chunk = co_await chunks.next();
+        co_return chunk->size();
+    }(path);
+    REQUIRE(get_scheduler().schedule(task) == 1024 * 1024);
+    unlink(path.c_str());
+}
+
+std::filesystem::path make_temp_tree() {
+    char dir[] = "/tmp/lazync_walk_XXXXXX";
+    std::filesystem::path root = mkdtemp(dir);
+    for (int a = 0; a < 4; ++a) {
+        auto level1 = root / ("dir" + std::to_string(a));
+        for (int b = 0; b < 3; ++b) {
+            auto level2 = level1 / ("sub" + std::to_string(b));
+            std::filesystem::create_directories(level2);
+            for (int f = 0; f < 5; ++f) {
+                std::ofstream(level2 / ("file" + std::to_string(f))) << f;
+            }
+        }
+        std::ofstream(level1 / "top") << a;
+    }
+    std::filesystem::create_symlink(root / "dir0", root / "link");
+    return root;
+}
+
+Task<std::set<std::string>> collect_walk(UvScheduler* scheduler, std::string root, WalkOptions options,
+                                         std::size_t* stats) {
+    auto walker = co_await walk_directory(*scheduler, std::move(root), options);
+    std::set<std::string> paths;
+    while (auto entry = co_await walker.next()) {
+        paths.insert(entry->path);
+    }
+    *stats = walker.stats();
+    co_return paths;
+}
+
+TEST_CASE("DirectoryWalker: Yields the same entries as std::filesystem", "[walk]") {
+    UvScheduler scheduler;
+    auto root = make_temp_tree();
+
+    std::set<std::string> expected;
+    for (auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+        expected.insert(entry.path().string());
+    }
+
+    for (std::size_t in_flight : {1, 4, 64}) {
+        std::size_t stats = 0;
+        auto task = collect_walk(&scheduler, root.string(), WalkOptions{.max_in_flight = in_flight}, &stats);
+        REQUIRE(scheduler.schedule(task) == expected);
+    }
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("DirectoryWalker: Type filter uses the dirent type", "[walk]") {
+    UvScheduler scheduler;
+    auto root = make_temp_tree();
+
+    std::size_t stats = 0;
+    WalkOptions options{.types = static_cast<unsigned>(EntryType::File)};
+    auto task = collect_walk(&scheduler, root.string(), options, &stats);
+    auto paths = scheduler.schedule(task);
+    REQUIRE(paths.size() == 4 * 3 * 5 + 4);
+    for (auto& path : paths) {
+        REQUIRE(std::filesystem::is_regular_file(std::filesystem::symlink_status(path)));
+    }
+    // tmpfs and ext4 report d_type, so no entry needs an lstat
+    REQUIRE(stats == 0);
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("DirectoryWalker: Missing root throws, early drop is safe", "[walk]") {
+    UvScheduler scheduler;
+
+    std::size_t stats = 0;
+    auto missing = collect_walk(&scheduler, "/nonexistent/lazync-walk", {}, &stats);
+    REQUIRE_THROWS_AS(scheduler.schedule(missing), std::system_error);
+
+    auto root = make_temp_tree();
+    auto first = [](UvScheduler* scheduler, std::string root) -> Task<bool> {
+        auto walker = co_await walk_directory(*scheduler, std::move(root), WalkOptions{.max_in_flight = 8});
+        co_return (co_await walker.next()).has_value();
+    }(&scheduler, root.string());
+    REQUIRE(scheduler.schedule(first));
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("TaskGraph: Nodes start when their inputs are ready", "[graph]") {
+    TaskGraph graph;
+    auto a = graph.add("a", []() -> Task<int> { co_await sleep_ms(20); co_return 1; });
+    auto b = graph.add("b", []() -> Task<int> { co_await sleep_ms(60); co_return 2; });
+    auto c = graph.add("c", [](int x, int y) -> Task<int> { co_await sleep_ms(10); co_return x + y; }, a, b);
+    auto d = graph.add("d", []() -> Task<int> { co_await sleep_ms(5); co_return 10; });
+    auto e = graph.add("e", [](int x, int y) -> Task<int> { co_return x * y; }, c, d);
+
+    auto start = std::chrono::steady_clock::now();
+    auto task = [](TaskGraph* graph) -> Task<void> {
+        co_await graph->run();
+    }(&graph);
+    get_scheduler().schedule(task);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(graph.take(e) == 30);
+    REQUIRE(elapsed < std::chrono::milliseconds(110));
+
+    auto path = graph.critical_path();
+    std::vector<std::string> names;
+    for (auto& node : path.nodes) {
+        names.push_back(node.name);
+    }
+    REQUIRE(names == std::vector<std::string>{"b", "c", "e"});
+    REQUIRE(path.length >= std::chrono::milliseconds(70));
+    REQUIRE(graph.timings().size() == 5);
+}
+
+struct CopyCounter {
+    static inline int copies = 0;
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter&) { ++copies; }
+    CopyCounter(CopyCounter&&) noexcept = default;
+    CopyCounter& operator=(const CopyCounter&) { ++copies; return *this; }
+    CopyCounter& operator=(CopyCounter&&) noexcept = default;
+};
+
+TEST_CASE("TaskGraph: Results are moved to their last consumer", "[graph]") {
+    TaskGraph graph;
+    auto owner = graph.add("owner", []() -> Task<std::unique_ptr<int>> { co_return std::make_unique<int>(7); });
+    auto unwrap = graph.add("unwrap", [](std::unique_ptr<int> p) -> Task<int> { co_return *p; }, owner);
+
+    CopyCounter::copies = 0;
+    auto source = graph.add("source", []() -> Task<CopyCounter> { co_return CopyCounter{}; });
+    auto chain = graph.add("chain", [](CopyCounter c) -> Task<CopyCounter> { co_return c; }, source);
+    for (int i = 0; i < 3; ++i) {
+        graph.add("fan" + std::to_string(i), [](CopyCounter) -> Task<int> { co_return 0; }, chain);
+    }
+
+    auto task = [](TaskGraph* graph) -> Task<void> {
+        co_await graph->run();
+    }(&graph);
+    get_scheduler().schedule(task);
+
+    REQUIRE(graph.take(unwrap) == 7);
+    // Only the fan-out to three consumers copies, once for each but the last
+    REQUIRE(CopyCounter::copies == 2);
+    REQUIRE_THROWS_AS(graph.take(owner), std::logic_error);
+}
+
+TEST_CASE("TaskGraph: Failures skip dependents and cycles are rejected", "[graph]") {
+    TaskGraph graph;
+    bool dependent_ran = false;
+    auto bad = graph.add("bad", []() -> Task<int> {
+        throw std::runtime_error("node failed");
+        co_return 0;
+    });
+    auto good = graph.add("good", []() -> Task<int> { co_await sleep_ms(5); co_return 5; });
+    graph.add("after", [&dependent_ran](int) -> Task<void> {
+        dependent_ran = true;
+        co_return;
+    }, bad);
+
+    auto task = [](TaskGraph* graph) -> Task<void> {
+        co_await graph->run();
+    }(&graph);
+    REQUIRE_THROWS_AS(get_scheduler().schedule(task), std::runtime_error);
+    REQUIRE_FALSE(dependent_ran);
+    REQUIRE(graph.take(good) == 5);
+
+    TaskGraph cyclic;
+    auto x = cyclic.add("x", []() -> Task<void> { co_return; });
+    auto y = cyclic.add("y", []() -> Task<void> { co_return; });
+    cyclic.precede(x, y);
+    cyclic.precede(y, x);
+    REQUIRE_THROWS_AS(cyclic.run(), std::logic_error);
+}
+
+void spin_for(std::chrono::milliseconds duration) {
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+TEST_CASE("LoopWatchdog: Flags a coroutine that blocks the loop", "[watchdog]") {
+    UvScheduler scheduler;
+    std::atomic<int> callbacks{0};
+    LoopWatchdog watchdog(scheduler, {.threshold = std::chrono::milliseconds(30),
+                                      .on_stall = [&](const LoopStall&) { ++callbacks; }});
+
+    auto task = [](UvScheduler* scheduler) -> Task<void> {
+        // Resumed by the loop directly, so the stall is attributed to this frame
+        co_await reschedule(*scheduler);
+        spin_for(std::chrono::milliseconds(120));
+        co_await sleep_ms(*scheduler, 10);
+    }(&scheduler);
+    scheduler.schedule(task);
+
+    auto stalls = watchdog.stalls();
+    REQUIRE(stalls.size() == 1);
+    REQUIRE(callbacks == 1);
+    REQUIRE(stalls[0].coroutine == task.get_handle().address());
+    REQUIRE(stalls[0].duration >= std::chrono::milliseconds(100));
+    REQUIRE_FALSE(stalls[0].stack.empty());
+    REQUIRE(stalls[0].symbols().size() == stalls[0].stack.size());
+}
+
+TEST_CASE("LoopWatchdog: Waiting in the loop is not a stall", "[watchdog]") {
+    UvScheduler scheduler;
+    LoopWatchdog watchdog(scheduler, {.threshold = std::chrono::milliseconds(20)});
+
+    auto task = [](UvScheduler* scheduler) -> Task<void> {
+        for (int i = 0; i < 5; ++i) {
+            co_await sleep_ms(*scheduler, 30);
+            spin_for(std::chrono::milliseconds(2));
+        }
+    }(&scheduler);
+    scheduler.schedule(task);
+
+    REQUIRE(watchdog.stalls().empty());
+}
+
+TEST_CASE("LatencyHistogram: Percentiles are within bucket precision", "[latency]") {
+    LatencyHistogram histogram;
+    for (std::uint64_t us = 1; us <= 1000; ++us) {
+        histogram.record(us * 1000);
+    }
+    LatencySnapshot snapshot;
+    snapshot.merge(histogram);
+
+    REQUIRE(snapshot.count() == 1000);
+    for (auto [p, expected] : {std::pair{50.0, 500'000.0}, std::pair{99.0, 990'000.0}, std::pair{99.9, 999'000.0}}) {
+        const auto value = static_cast<double>(snapshot.percentile(p).count());
+        REQUIRE(value >= expected);
+        REQUIRE(value <= expected * 1.035);
+    }
+    REQUIRE(LatencyHistogram::bucket_index(63) == 63);
+    REQUIRE(LatencyHistogram::bucket_high(LatencyHistogram::bucket_index(1'000'000)) >= 1'000'000);
+}
+
+TEST_CASE("LatencyHistogram: Per-thread histograms are merged by name", "[latency]") {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; ++i) {
+                record_task_latency("test.threads", 1000, 500);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto latency = task_latency("test.threads");
+    REQUIRE(latency.wall.count() == 4000);
+    REQUIRE(latency.cpu.count() == 4000);
+    REQUIRE(task_latency("test.unknown").wall.count() == 0);
+}
+
+TEST_CASE("Task: Named tasks record wall and on-CPU time", "[latency]") {
+    auto step = []() -> Task<int> {
+        co_await named("test.step");
+        co_await sleep_ms(20);
+        spin_for(std::chrono::milliseconds(5));
+        co_return 1;
+    };
+    auto task = [](auto step) -> Task<int> {
+        int total = 0;
+        for (int i = 0; i < 10; ++i) {
+            total += co_await step();
+        }
+        co_return total;
+    }(step);
+    REQUIRE(get_scheduler().schedule(task) == 10);
+
+    auto latency = task_latency("test.step");
+    REQUIRE(latency.wall.count() == 10);
+    REQUIRE(latency.wall.percentile(50) >= std::chrono::milliseconds(24));
+    // The sleep is off-CPU, the spin is not
+    REQUIRE(latency.cpu.percentile(50) >= std::chrono::microseconds(4800));
+    REQUIRE(latency.cpu.percentile(50) < std::chrono::milliseconds(15));
+}
+
+TEST_CASE("Task: Awaits that complete without suspending keep on-CPU time", "[latency]") {
+    auto task = []() -> Task<int> {
+        co_await named("test.ready_await");
+        spin_for(std::chrono::milliseconds(20));
+        co_return co_await make_ready_task(1);
+    }();
+    REQUIRE(get_scheduler().schedule(task) == 1);
+
+    auto latency = task_latency("test.ready_await");
+    REQUIRE(latency.cpu.count() == 1);
+    REQUIRE(latency.cpu.percentile(50) >= std::chrono::milliseconds(19));
+}
+
+TEST_CASE("when_all_local: Results in argument order, void as monostate", "[when_all]") {
+    auto value = [](int v) -> Task<int> { co_return v; };
+    auto nothing = []() -> Task<void> { co_return; };
+    auto delayed = [](int delay, int v) -> Task<int> {
+        co_await sleep_ms(delay);
+        co_return v;
+    };
+
+    auto task = [](auto value, auto nothing, auto delayed) -> Task<int> {
+        // Completes while starting, without suspending
+        auto [a, b] = co_await when_all_local(value(1), value(2));
+        auto [c, none, d] = co_await when_all_local(delayed(30, 3), nothing(), delayed(10, 4));
+        static_assert(std::is_same_v<decltype(none), std::monostate>);
+        co_await when_all_local(nothing(), nothing());
+        co_return a + b + c + d;
+    }(value, nothing, delayed);
+
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(get_scheduler().schedule(task) == 10);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(60));
+}
+
+TEST_CASE("when_all_local: Rethrows the first exception after all tasks finish", "[when_all]") {
+    bool finished = false;
+    auto failing = [](int delay) -> Task<int> {
+        co_await sleep_ms(delay);
+        throw std::runtime_error("task failed");
+        co_return 0;
+    };
+    auto slow = [](bool* finished) -> Task<void> {
+        co_await sleep_ms(20);
+        *finished = true;
+    };
+
+    auto task = [](auto failing, auto slow, bool* finished) -> Task<void> {
+        co_await when_all_local(failing(5), slow(finished));
+    }(failing, slow, &finished);
+
+    REQUIRE_THROWS_AS(get_scheduler().schedule(task), std::runtime_error);
+    REQUIRE(finished);
+}
+
+TEST_CASE("ValueOrTask: Ready values complete without suspending", "[ready]") {
+    auto fetch = [](int key) -> Task<int> {
+        co_await sleep_ms(5);
+        co_return key * 10;
+    };
+    auto lookup = [fetch](int key) -> ValueOrTask<int> {
+        if (key < 3) {
+            return make_ready_task(key);
+        }
+        return fetch(key);
+    };
+
+    // Only ready values: the whole coroutine runs in one resume, without the scheduler
+    auto hits = [](auto lookup) -> Task<int> {
+        int sum = 0;
+        for (int i = 0; i < 3; ++i) {
+            sum += co_await lookup(i);
+        }
+        co_await make_ready_task();
+        co_return sum;
+    }(lookup);
+    hits.get_handle().resume();
+    REQUIRE(hits.done());
+    REQUIRE(hits.get_handle().promise().value == 3);
+
+    auto mixed = [](auto lookup) -> Task<int> {
+        co_return co_await lookup(1) + co_await lookup(5);
+    }(lookup);
+    REQUIRE(get_scheduler().schedule(mixed) == 51);
+}
+
+TEST_CASE("EagerTask: Runs on call and completes inline", "[ready]") {
+    int steps = 0;
+    auto inline_body = [](int* steps) -> EagerTask<int> {
+        ++*steps;
+        co_return 7;
+    };
+    auto suspending = [](int* steps) -> EagerTask<int> {
+        ++*steps;
+        co_await sleep_ms(5);
+        ++*steps;
+        co_return 8;
+    };
+    auto failing = []() -> EagerTask<void> {
+        throw std::runtime_error("eager failure");
+        co_return;
+    };
+
+    auto eager = inline_body(&steps);
+    REQUIRE(steps == 1);
+    REQUIRE(eager.done());
+
+    auto task = [](auto inline_body, auto suspending, auto failing, int* steps) -> Task<int> {
+        int sum = co_await inline_body(steps);
+        auto pending = suspending(steps);
+        sum += co_await pending;
+        try {
+            co_await failing();
+        } catch (const std::runtime_error&) {
+            sum += 100;
+        }
+        co_return sum;
+    }(inline_body, suspending, failing, &steps);
+    REQUIRE(get_scheduler().schedule(task) == 115);
+    REQUIRE(steps == 4);
+}
+
+struct IpcMessage {
+    std::uint64_t producer;
+    std::uint64_t sequence;
+};
+
+TEST_CASE("IpcChannel: Messages from another process arrive in order", "[ipc]") {
+    using Channel = IpcChannel<IpcMessage, IpcProducers::Single>;
+    constexpr std::uint64_t count = 20000;
+    UvScheduler scheduler;
+    auto channel = Channel::create(64);
+
+    pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        auto producer = Channel::attach(dup(channel.memory_fd()), dup(channel.event_fd()));
+        for (std::uint64_t i = 0; i < count; ++i) {
+            while (!producer.try_send_with([i](IpcMessage& slot) { slot = IpcMessage{0, i}; })) {
+                sched_yield();
+            }
+        }
+        _exit(0);
+    }
+
+    auto task = [](UvScheduler* scheduler, Channel* channel, std::uint64_t count) -> Task<std::uint64_t> {
+        std::uint64_t in_order = 0;
+        for (std::uint64_t i = 0; i < count; ++i) {
+            auto message = co_await channel->receive(*scheduler);
+            in_order += message.sequence == i;
+        }
+        co_return in_order;
+    }(&scheduler, &channel, count);
+    REQUIRE(scheduler.schedule(task) == count);
+
+    int status = 0;
+    REQUIRE(waitpid(child, &status, 0) == child);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE_FALSE(channel.try_receive());
+}
+
+TEST_CASE("IpcChannel: Concurrent producers, zero-copy drain", "[ipc]") {
+    constexpr std::uint64_t producers = 4;
+    constexpr std::uint64_t per_producer = 10000;
+    UvScheduler scheduler;
+    auto channel = IpcChannel<IpcMessage>::create(128);
+    REQUIRE(channel.capacity() == 128);
+
+    std::vector<std::thread> threads;
+    for (std::uint64_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&channel, p] {
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                while (!channel.try_send(IpcMessage{p, i})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    auto task = [](UvScheduler* scheduler, IpcChannel<IpcMessage>* channel) -> Task<bool> {
+        std::vector<std::uint64_t> next(producers, 0);
+        std::uint64_t received = 0;
+        bool in_order = true;
+        while (received < producers * per_producer) {
+            co_await channel->readable(*scheduler);
+            received += channel->drain([&next, &in_order](const IpcMessage& message) {
+                in_order = in_order && message.sequence == next[message.producer]++;
+            });
+        }
+        co_return in_order;
+    }(&scheduler, &channel);
+    REQUIRE(scheduler.schedule(task));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+TEST_CASE("IpcChannel: Producers only signal a waiting consumer", "[ipc]") {
+    UvScheduler scheduler;
+    auto channel = IpcChannel<IpcMessage>::create(8);
+    std::uint64_t counter = 0;
+
+    // Nobody is waiting: no eventfd write, and a full ring refuses more
+    for (std::uint64_t i = 0; i < 8; ++i) {
+        REQUIRE(channel.try_send(IpcMessage{0, i}));
+    }
+    REQUIRE_FALSE(channel.try_send(IpcMessage{0, 8}));
+    REQUIRE(read(channel.event_fd(), &counter, sizeof(counter)) < 0);
+    REQUIRE(channel.drain([](const IpcMessage&) {}) == 8);
+
+    // One signal ends the wait, however many messages follow it
+    bool sent = true;
+    std::thread producer([&channel, &sent] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (std::uint64_t i = 0; i < 4; ++i) {
+            sent = channel.try_send(IpcMessage{0, i}) && sent;
+        }
+    });
+    auto task = [](UvScheduler* scheduler, IpcChannel<IpcMessage>* channel) -> Task<std::uint64_t> {
+        auto message = co_await channel->receive(*scheduler);
+        co_return message.sequence;
+    }(&scheduler, &channel);
+    REQUIRE(scheduler.schedule(task) == 0);
+    producer.join();
+    REQUIRE(sent);
+    REQUIRE(read(channel.event_fd(), &counter, sizeof(counter)) < 0);
+    REQUIRE(channel.drain([](const IpcMessage&) {}) == 3);
+
+    auto other = IpcChannel<std::uint32_t>::create(8);
+    REQUIRE_THROWS_AS(IpcChannel<IpcMessage>::attach(dup(other.memory_fd()), dup(other.event_fd())),
+                      std::invalid_argument);
+}
+
+#if defined(LAZYNC_TASK_REGISTRY)
+// Parks the awaiting task until the test resumes it
+struct ParkedAwaitable {
+    std::coroutine_handle<>* parked;
+
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<> coro) { *parked = coro; }
+    void await_resume() {}
+};
+
+Task<void> park(std::coroutine_handle<>* parked) {
+    co_await ParkedAwaitable{parked};
+}
+
+TEST_CASE("Task registry: Live tasks are dumped as async stacks", "[registry]") {
+    std::coroutine_handle<> parked;
+    auto middle = [](std::coroutine_handle<>* parked) -> Task<void> {
+        co_await named("test.middle");
+        co_await park(parked);
+    };
+    auto task = [](auto middle, std::coroutine_handle<>* parked) -> Task<void> {
+        co_await named("test.outer");
+        co_await middle(parked);
+    }(middle, &parked);
+
+    // Nothing else keeps the loop alive, so schedule() returns with the task parked
+    get_scheduler().schedule(task);
+    REQUIRE(parked);
+    REQUIRE_FALSE(task.done());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    std::vector<AsyncStack> stacks;
+    std::string text;
+    std::thread([&stacks, &text] {
+        stacks = live_task_stacks();
+        text = format_task_stacks();
+    }).join();
+
+    get_scheduler().post(parked);
+    get_scheduler().run();
+    REQUIRE(task.done());
+
+    auto it = std::find_if(stacks.begin(), stacks.end(), [](const AsyncStack& stack) {
+        return stack.size() == 3 && stack[1].name && std::string(stack[1].name) == "test.middle";
+    });
+    REQUIRE(it != stacks.end());
+    const auto& stack = *it;
+    REQUIRE(stack[2].name == std::string("test.outer"));
+    REQUIRE(stack[0].name == nullptr);
+    REQUIRE(stack[0].awaiting_type().find("ParkedAwaitable") != std::string::npos);
+    REQUIRE(stack[1].awaiting_type().find("Task<void>::awaiter") != std::string::npos);
+    REQUIRE(stack[0].continuation == stack[1].address);
+    REQUIRE(stack[2].address == task.get_handle().address());
+    for (const auto& frame : stack) {
+        REQUIRE(frame.size > 0);
+        REQUIRE(frame.age >= std::chrono::milliseconds(20));
+        REQUIRE_FALSE(frame.done);
+    }
+    REQUIRE(text.find("test.middle") != std::string::npos);
+    REQUIRE(text.find("awaiting ParkedAwaitable") != std::string::npos);
+}
+
+TEST_CASE("Task registry: Frames are counted until destroyed", "[registry]") {
+    const auto before = live_task_stats();
+    auto make = [](int v) -> Task<int> { co_return v; };
+    {
+        std::vector<Task<int>> tasks;
+        for (int i = 0; i < 10; ++i) {
+            tasks.push_back(make(i));
+        }
+        // Finished frames stay alive, and counted, until their Task is destroyed
+        REQUIRE(get_scheduler().schedule(tasks[0]) == 0);
+        const auto live = live_task_stats();
+        REQUIRE(live.count == before.count + 10);
+        REQUIRE(live.bytes >= before.bytes + 10 * sizeof(Task<int>::promise_type));
+
+        auto stacks = live_task_stacks();
+        auto finished = std::count_if(stacks.begin(), stacks.end(), [&tasks](const AsyncStack& stack) {
+            return stack[0].address == tasks[0].get_handle().address();
+        });
+        REQUIRE(finished == 1);
+    }
+    REQUIRE(live_task_stats().count == before.count);
+    REQUIRE(live_task_stats().bytes == before.bytes);
+}
+
+TEST_CASE("Task registry: Resumed frames no longer report an awaiter", "[registry]") {
+    auto task = []() -> Task<bool> {
+        co_await named("test.resumed");
+        co_await sleep_ms(1);
+        for (const auto& stack : live_task_stacks()) {
+            if (stack[0].name && std::string(stack[0].name) == "test.resumed") {
+                co_return stack[0].awaiting == nullptr;
+            }
+        }
+        co_return false;
+    }();
+    REQUIRE(get_scheduler().schedule(task));
+}
+
+TEST_CASE("Task registry: Frames destroyed on another thread are unlinked", "[registry]") {
+    const auto before = live_task_stats();
+    auto make = [](int v) -> Task<int> { co_return v; };
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 1000; ++i) {
+        tasks.push_back(make(i));
+    }
+    REQUIRE(live_task_stats().count == before.count + 1000);
+    std::thread([&tasks] { tasks.clear(); }).join();
+    REQUIRE(live_task_stats().count == before.count);
+    REQUIRE(live_task_stats().bytes == before.bytes);
+}
+
+TEST_CASE("Task registry: The dump signal writes the stacks", "[registry]") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    install_task_dump_signal(fds[1]);
+    REQUIRE(raise(SIGUSR2) == 0);
+
+    std::string text;
+    char buffer[4096];
+    while (text.find(" live tasks, ") == std::string::npos) {
+        const auto n = read(fds[0], buffer, sizeof(buffer));
+        REQUIRE(n > 0);
+        text.append(buffer, static_cast<std::size_t>(n));
+    }
+    install_task_dump_signal(STDERR_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
@@ -10,21 +10,30 @@
 
 #include <chrono>
 
-// Sleep awaitable that uses the scheduler
-struct SleepAwaitable {
-    SleepAwaitable(std::chrono::milliseconds duration) : duration(duration) {}
+// Sleep awaitable on a given scheduler
+template<typename Sched>
+struct BasicSleepAwaitable {
+    BasicSleepAwaitable(Sched& scheduler, std::chrono::milliseconds duration)
+        : scheduler(scheduler), duration(duration) {}
+    Sched& scheduler;
     std::chrono::milliseconds duration;
-    Scheduler::TimerHandle timerHandle;
+    typename Sched::TimerHandle timerHandle;
 
     bool await_ready() { return duration.count() == 0; }
 
-    void await_suspend(std::coroutine_handle<> coro) {
-        get_scheduler().schedule_after(coro, duration, timerHandle);
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> coro) {
+        scheduler.schedule_after(coro, duration, timerHandle, priority_of(coro));
     }
 
     void await_resume() {}
 };
 
+// Sleep awaitable that uses the scheduler
+struct SleepAwaitable : BasicSleepAwaitable<Scheduler> {
+    SleepAwaitable(std::chrono::milliseconds duration) : BasicSleepAwaitable(get_scheduler(), duration) {}
+};
+
 inline Task<void> sleep(int seconds) {
     co_await SleepAwaitable{std::chrono::milliseconds(seconds * 1000)};
 }
@@ -33,5 +42,10 @@ inline Task<void> sleep_ms(int milliseconds) {
     co_await SleepAwaitable{std::chrono::milliseconds(milliseconds)};
 }
 
+template<typename Sched>
+Task<void> sleep_ms(Sched& scheduler, int milliseconds) {
+    co_await BasicSleepAwaitable<Sched>{scheduler, std::chrono::milliseconds(milliseconds)};
+}
+
 
 #endif //CATCH2TESTEXAMPLE_TIMER_HPP
\ No newline at end of file
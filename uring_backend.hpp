@@ -0,0 +1,396 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_URING_BACKEND_HPP
+#define CATCH2TESTEXAMPLE_URING_BACKEND_HPP
+
+#include "event_backend.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <mutex>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// io_uring event backend on the raw syscall interface. Timers, wakeups and reads/writes are
+// all submitted as SQEs, so one io_uring_enter both flushes a batch and waits for completions.
+class UringBackend {
+public:
+    // Common head of everything that can be carried in an SQE's user_data
+    struct Completion {
+        void (*complete)(Completion&, int res) = nullptr;
+    };
+
+    struct Timer : Completion {
+        __kernel_timespec timeout{};
+        void* data = nullptr;
+        void (*callback)(Timer&) = nullptr;
+    };
+
+    struct Wakeup : Completion {
+        int fd = -1;
+        std::uint64_t counter = 0;
+        bool closing = false;
+        UringBackend* backend = nullptr;
+        void* data = nullptr;
+        void (*callback)(Wakeup&) = nullptr;
+    };
+
+    struct IoRequest : IoRequestBase, Completion {
+        void* data = nullptr;
+        void (*callback)(IoRequest&) = nullptr;
+    };
+
+    struct Work {
+        void* data = nullptr;
+        void (*work)(Work&) = nullptr;
+        void (*callback)(Work&) = nullptr;
+    };
+
+    static constexpr unsigned queue_depth = 256;
+
+    UringBackend(void* owner, void (*drain)(void*)) : owner(owner), drain(drain) {
+        io_uring_params params{};
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+        if (ring_fd < 0) {
+            throw std::system_error(errno, std::system_category(), "io_uring_setup");
+        }
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+
+        sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+        cq_ring = single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+
+        auto* sq = static_cast<char*>(sq_ring);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        auto* cq = static_cast<char*>(cq_ring);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    ~UringBackend() {
+        {
+            std::lock_guard lock(pool.mutex);
+            pool.stopping = true;
+        }
+        pool.cv.notify_all();
+        for (auto& thread : pool.threads) {
+            thread.join();
+        }
+        if (pool.done.fd >= 0) {
+            close(pool.done.fd);
+        }
+
+        munmap(sqes, sqes_size);
+        if (!single_mmap) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        munmap(sq_ring, sq_ring_size);
+        close(ring_fd);
+    }
+
+    UringBackend(const UringBackend&) = delete;
+    UringBackend& operator=(const UringBackend&) = delete;
+
+    void start_draining() { draining = true; }
+    void stop_draining() { draining = false; }
+
+    void start_timer(Timer& timer, std::chrono::milliseconds delay) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+        timer.timeout.tv_sec = ns / 1'000'000'000;
+        timer.timeout.tv_nsec = ns % 1'000'000'000;
+        timer.complete = [](Completion& c, int) {
+            auto& t = static_cast<Timer&>(c);
+            t.callback(t);
+        };
+
+        auto* sqe = get_sqe(timer);
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&timer.timeout);
+        sqe->len = 1;
+        sqe->off = 0;
+    }
+
+    void init_wakeup(Wakeup& wakeup) {
+        wakeup.fd = eventfd(0, EFD_CLOEXEC);
+        if (wakeup.fd < 0) {
+            throw std::system_error(errno, std::system_category(), "eventfd");
+        }
+        wakeup.backend = this;
+        wakeup.closing = false;
+        wakeup.complete = [](Completion& c, int) {
+            auto& w = static_cast<Wakeup&>(c);
+            if (w.closing) {
+                close(w.fd);
+                w.fd = -1;
+                return;
+            }
+            w.backend->arm(w);
+            w.callback(w);
+        };
+        arm(wakeup);
+    }
+
+    // Thread-safe; sends before the callback runs are coalesced by the eventfd counter
+    static void send(Wakeup& wakeup) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] auto res = write(wakeup.fd, &one, sizeof(one));
+    }
+
+    // The pending eventfd read completes once more and is not re-armed
+    void close_wakeup(Wakeup& wakeup) {
+        wakeup.closing = true;
+        send(wakeup);
+    }
+
+    void submit(IoRequest& request) {
+        request.complete = [](Completion& c, int res) {
+            auto& r = static_cast<IoRequest&>(c);
+            r.result = res;
+            r.callback(r);
+        };
+
+        auto* sqe = get_sqe(request);
+        sqe->opcode = request.kind == IoKind::Read ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->fd = request.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(request.buffer);
+        sqe->len = static_cast<unsigned>(request.length);
+        sqe->off = static_cast<std::uint64_t>(request.offset);
+    }
+
+    // Runs on the backend's own worker threads; finished work is handed back through an eventfd
+    // that has a read pending only while work is outstanding
+    void queue_work(Work& work) {
+        if (pool.threads.empty()) {
+            start_pool();
+        }
+        {
+            std::lock_guard lock(pool.mutex);
+            pool.queued.push_back(&work);
+        }
+        pool.cv.notify_one();
+
+        if (pool.outstanding++ == 0) {
+            arm_work_done();
+        }
+    }
+
+    void run() {
+        for (;;) {
+            reap();
+            if (draining) {
+                drain(owner);
+            }
+            if (!draining && in_flight == 0) {
+                break;
+            }
+            // Flush everything queued since the last pass; block only when there is no ready work
+            enter(draining ? 0 : 1);
+        }
+    }
+
+private:
+    void* map(std::size_t size, std::uint64_t offset) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                         static_cast<off_t>(offset));
+        if (ptr == MAP_FAILED) {
+            throw std::system_error(errno, std::system_category(), "io_uring mmap");
+        }
+        return ptr;
+    }
+
+    io_uring_sqe* get_sqe(Completion& completion) {
+        auto tail = *sq_tail;
+        if (tail - std::atomic_ref(*sq_head).load(std::memory_order_acquire) == sq_entries) {
+            enter(0);
+            tail = *sq_tail;
+        }
+        const auto index = tail & sq_mask;
+        auto* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = reinterpret_cast<std::uint64_t>(&completion);
+        sq_array[index] = index;
+        std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+        ++to_submit;
+        ++in_flight;
+        return sqe;
+    }
+
+    void arm(Wakeup& wakeup) {
+        auto* sqe = get_sqe(wakeup);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wakeup.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&wakeup.counter);
+        sqe->len = sizeof(wakeup.counter);
+        sqe->off = static_cast<std::uint64_t>(-1);
+    }
+
+    struct WorkDone : Completion {
+        int fd = -1;
+        std::uint64_t counter = 0;
+        UringBackend* backend = nullptr;
+    };
+
+    struct WorkerPool {
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Work*> queued;
+        std::vector<Work*> finished;
+        bool stopping = false;
+        std::size_t outstanding = 0;  // loop thread only
+        WorkDone done;
+    };
+
+    void start_pool() {
+        pool.done.fd = eventfd(0, EFD_CLOEXEC);
+        if (pool.done.fd < 0) {
+            throw std::system_error(errno, std::system_category(), "eventfd");
+        }
+        pool.done.backend = this;
+        pool.done.complete = [](Completion& c, int) {
+            static_cast<WorkDone&>(c).backend->complete_work();
+        };
+
+        const auto count = std::max(4u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < count; ++i) {
+            pool.threads.emplace_back([this] { worker(); });
+        }
+    }
+
+    void worker() {
+        for (;;) {
+            Work* work;
+            {
+                std::unique_lock lock(pool.mutex);
+                pool.cv.wait(lock, [&] { return pool.stopping || !pool.queued.empty(); });
+                if (pool.queued.empty()) {
+                    return;
+                }
+                work = pool.queued.front();
+                pool.queued.pop_front();
+            }
+
+            work->work(*work);
+
+            {
+                std::lock_guard lock(pool.mutex);
+                pool.finished.push_back(work);
+            }
+            const std::uint64_t one = 1;
+            [[maybe_unused]] auto res = write(pool.done.fd, &one, sizeof(one));
+        }
+    }
+
+    void arm_work_done() {
+        auto* sqe = get_sqe(pool.done);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = pool.done.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&pool.done.counter);
+        sqe->len = sizeof(pool.done.counter);
+        sqe->off = static_cast<std::uint64_t>(-1);
+    }
+
+    void complete_work() {
+        std::vector<Work*> finished;
+        {
+            std::lock_guard lock(pool.mutex);
+            finished.swap(pool.finished);
+        }
+        pool.outstanding -= finished.size();
+        // Re-arm first: callbacks may queue more work, which must not arm a second read
+        if (pool.outstanding > 0) {
+            arm_work_done();
+        }
+        for (auto* work : finished) {
+            work->callback(*work);
+        }
+    }
+
+    void enter(unsigned min_complete) {
+        const unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+        if (to_submit == 0 && min_complete == 0) {
+            return;
+        }
+        int res;
+        do {
+            res = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+        } while (res < 0 && errno == EINTR);
+        if (res < 0) {
+            throw std::system_error(errno, std::system_category(), "io_uring_enter");
+        }
+        to_submit -= static_cast<unsigned>(res) < to_submit ? static_cast<unsigned>(res) : to_submit;
+    }
+
+    void reap() {
+        auto head = *cq_head;
+        const auto tail = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+        while (head != tail) {
+            const auto& cqe = cqes[head & cq_mask];
+            auto* completion = reinterpret_cast<Completion*>(cqe.user_data);
+            const int res = cqe.res;
+            ++head;
+            // Publish the slot before the callback, which may queue new work
+            std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+            --in_flight;
+            completion->complete(*completion, res);
+        }
+    }
+
+    int ring_fd = -1;
+    void* sq_ring = nullptr;
+    void* cq_ring = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sq_ring_size = 0;
+    std::size_t cq_ring_size = 0;
+    std::size_t sqes_size = 0;
+    bool single_mmap = false;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned sq_entries = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    WorkerPool pool;
+    unsigned to_submit = 0;
+    std::size_t in_flight = 0;
+    bool draining = false;
+    void* owner;
+    void (*drain)(void*);
+};
+
+
+#endif //CATCH2TESTEXAMPLE_URING_BACKEND_HPP
@@ -1,6 +1,18 @@
+#ifndef CATCH2TESTEXAMPLE_UTILS_HPP
+#define CATCH2TESTEXAMPLE_UTILS_HPP
+
 #include "task.hpp"
 
 #include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 // Helper to extract return type from Task<T>
 template<typename T>
@@ -61,20 +73,21 @@ private:
         auto handle = task.get_handle();
 
         // Create and store a completion handler that captures the task result
-        auto completion_handler = create_completion_coro<I>(state_, handle);
+        auto completion_handler = create_completion_coro<I>(state_.get(), handle);
         auto completion_handle = completion_handler.get_handle();
         state_->completion_handlers.push_back(std::move(completion_handler));
 
         // Set continuation
-        handle.promise().continuation = completion_handle;
+        handle.promise().set_continuation(completion_handle);
 
         // Start the task
         handle.resume();
     }
 
+    // Completions borrow the state: it owns them, so owning it back would leak both
     template<size_t I>
     static Task<void> create_completion_coro(
-        std::shared_ptr<State> state,
+        State* state,
         std::coroutine_handle<typename std::remove_reference_t<
             std::tuple_element_t<I, std::tuple<Tasks...>>
         >::promise_type> task_handle) {
@@ -83,7 +96,7 @@ private:
         //using ReturnType = task_return_type_t<TaskType>;
 
         struct Awaiter {
-            std::shared_ptr<State> state;
+            State* state;
             std::coroutine_handle<typename TaskType::promise_type> task_handle;
 
             bool await_ready() { return false; }
@@ -147,17 +160,17 @@ private:
         auto& task = std::get<I>(tasks_);
         auto handle = task.get_handle();
 
-        auto completion_handler = create_completion_coro(state_);
+        auto completion_handler = create_completion_coro(state_.get());
         auto completion_handle = completion_handler.get_handle();
         state_->completion_handlers.push_back(std::move(completion_handler));
 
-        handle.promise().continuation = completion_handle;
+        handle.promise().set_continuation(completion_handle);
         handle.resume();
     }
 
-    static Task<void> create_completion_coro(std::shared_ptr<State> state) {
+    static Task<void> create_completion_coro(State* state) {
         struct Awaiter {
-            std::shared_ptr<State> state;
+            State* state;
             bool await_ready() { return false; }
             void await_suspend(std::coroutine_handle<>) {
                 if (--(state->remaining_count) == 0) {
@@ -173,6 +186,166 @@ private:
     std::shared_ptr<State> state_;
 };
 
+// when_all over a runtime number of tasks of the same type
+template<typename T>
+class WhenAllRangeAwaitable {
+public:
+    explicit WhenAllRangeAwaitable(std::vector<Task<T>> tasks)
+        : tasks_(std::move(tasks))
+        , state_(std::make_shared<State>()) {
+        state_->remaining_count = tasks_.size();
+        state_->completion_handlers.reserve(tasks_.size());
+    }
+
+    bool await_ready() { return tasks_.empty(); }
+
+    void await_suspend(std::coroutine_handle<> awaiting_coro) {
+        state_->awaiting = awaiting_coro;
+        for (auto& task : tasks_) {
+            auto handle = task.get_handle();
+
+            auto completion_handler = create_completion_coro(state_.get());
+            handle.promise().set_continuation(completion_handler.get_handle());
+            state_->completion_handlers.push_back(std::move(completion_handler));
+
+            handle.resume();
+        }
+    }
+
+    // Results in task order; the first task that threw has its exception rethrown
+    auto await_resume() {
+        for (auto& task : tasks_) {
+            if (task.get_handle().promise().exception) {
+                std::rethrow_exception(task.get_handle().promise().exception);
+            }
+        }
+        if constexpr (!std::is_void_v<T>) {
+            std::vector<T> results;
+            results.reserve(tasks_.size());
+            for (auto& task : tasks_) {
+                results.push_back(std::move(task.get_handle().promise().value));
+            }
+            return results;
+        }
+    }
+
+private:
+    struct State {
+        std::coroutine_handle<> awaiting;
+        std::atomic<size_t> remaining_count{0};
+        std::vector<Task<void>> completion_handlers;
+    };
+
+    // The awaitable lives in the awaiting frame until every task has finished, so the completion
+    // coroutines borrow the state; owning it would form a cycle through completion_handlers
+    static Task<void> create_completion_coro(State* state) {
+        struct Awaiter {
+            State* state;
+            bool await_ready() { return false; }
+            // The last task to finish transfers straight to the awaiting coroutine
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<>) {
+                if (--(state->remaining_count) == 0) {
+                    return state->awaiting;
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() {}
+        };
+        co_await Awaiter{state};
+    }
+
+    std::vector<Task<T>> tasks_;
+    std::shared_ptr<State> state_;
+};
+
+template<typename T>
+WhenAllRangeAwaitable<T> when_all(std::vector<Task<T>> tasks) {
+    return WhenAllRangeAwaitable<T>(std::move(tasks));
+}
+
+// when_all for tasks that all complete on the awaiting coroutine's thread. All state lives in the
+// awaitable, which sits in the awaiting frame: a plain countdown, and a completion hook on each
+// task instead of an extra completion coroutine. Void results become std::monostate in the tuple;
+// an all-void when_all returns void. The first task (in argument order) that threw has its
+// exception rethrown.
+template<typename... Tasks>
+class LocalWhenAllAwaitable {
+    template<typename T>
+    using result_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    static constexpr bool all_void = (std::is_void_v<task_return_type_t<std::remove_reference_t<Tasks>>> && ...);
+
+public:
+    explicit LocalWhenAllAwaitable(Tasks&&... tasks) : tasks_(std::forward<Tasks>(tasks)...) {}
+
+    LocalWhenAllAwaitable(const LocalWhenAllAwaitable&) = delete;
+    LocalWhenAllAwaitable& operator=(const LocalWhenAllAwaitable&) = delete;
+
+    bool await_ready() { return sizeof...(Tasks) == 0; }
+
+    // Starts every task; does not suspend if they all completed while being started
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> awaiting_coro) {
+        awaiting_ = awaiting_coro;
+        remaining_ = sizeof...(Tasks) + 1;  // held until all are started
+        std::apply([&](auto&... task) {
+            (start(task.get_handle(), priority_of(awaiting_coro)), ...);
+        }, tasks_);
+        return --remaining_ != 0;
+    }
+
+    auto await_resume() {
+        std::exception_ptr exception;
+        std::apply([&](auto&... task) {
+            ((exception = exception ? exception : task.get_handle().promise().exception), ...);
+        }, tasks_);
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        if constexpr (!all_void) {
+            return std::apply([](auto&... task) {
+                return std::tuple<result_t<task_return_type_t<std::remove_reference_t<Tasks>>>...>(take(task)...);
+            }, tasks_);
+        }
+    }
+
+private:
+    template<typename Handle>
+    void start(Handle handle, Priority priority) {
+        handle.promise().priority = priority;
+        handle.promise().on_complete = on_task_complete;
+        handle.promise().on_complete_context = this;
+        handle.resume();
+    }
+
+    static std::coroutine_handle<> on_task_complete(void* self) {
+        auto* awaitable = static_cast<LocalWhenAllAwaitable*>(self);
+        if (--awaitable->remaining_ == 0) {
+            return awaitable->awaiting_;
+        }
+        return std::noop_coroutine();
+    }
+
+    template<typename T>
+    static auto take(Task<T>& task) {
+        if constexpr (std::is_void_v<T>) {
+            return std::monostate{};
+        } else {
+            return std::move(task.get_handle().promise().value);
+        }
+    }
+
+    std::tuple<Tasks...> tasks_;
+    std::size_t remaining_ = 0;
+    std::coroutine_handle<> awaiting_;
+};
+
+// Single-threaded when_all: every task must complete on the thread that awaits the result
+template<typename... Tasks>
+LocalWhenAllAwaitable<Tasks...> when_all_local(Tasks&&... tasks) {
+    return LocalWhenAllAwaitable<Tasks...>(std::forward<Tasks>(tasks)...);
+}
+
 // when_all factory function - dispatches to appropriate implementation
 template<typename... Tasks>
 auto when_all(Tasks&&... tasks) {
@@ -184,3 +357,6 @@ auto when_all(Tasks&&... tasks) {
         return WhenAllAwaitable<Tasks...>(std::forward<Tasks>(tasks)...);
     }
 }
+
+
+#endif //CATCH2TESTEXAMPLE_UTILS_HPP
@@ -0,0 +1,178 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_UV_BACKEND_HPP
+#define CATCH2TESTEXAMPLE_UV_BACKEND_HPP
+
+#include "event_backend.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <uv.h>
+#include <vector>
+
+// libuv event backend; file I/O and queued work go through the libuv threadpool
+class UvBackend {
+public:
+    struct Timer {
+        uv_timer_t* handle = nullptr;  // borrowed from the backend's pool while the timer runs
+        void* data = nullptr;
+        void (*callback)(Timer&) = nullptr;
+    };
+
+    struct Wakeup {
+        uv_async_t handle;
+        void* data = nullptr;
+        void (*callback)(Wakeup&) = nullptr;
+    };
+
+    struct IoRequest : IoRequestBase {
+        uv_fs_t req;
+        void* data = nullptr;
+        void (*callback)(IoRequest&) = nullptr;
+    };
+
+    struct Work {
+        uv_work_t req;
+        void* data = nullptr;
+        void (*work)(Work&) = nullptr;
+        void (*callback)(Work&) = nullptr;
+    };
+
+    UvBackend(void* owner, void (*drain)(void*)) : owner(owner), drain(drain) {
+        uv_loop_init(&loop);
+        loop.data = this;
+        uv_idle_init(&loop, &drain_idle);
+        drain_idle.data = this;
+    }
+
+    ~UvBackend() {
+        uv_close(reinterpret_cast<uv_handle_t*>(&drain_idle), nullptr);
+        for (auto& handle : timers) {
+            uv_close(reinterpret_cast<uv_handle_t*>(handle.get()), nullptr);
+        }
+        uv_run(&loop, UV_RUN_NOWAIT);
+        uv_loop_close(&loop);
+    }
+
+    UvBackend(const UvBackend&) = delete;
+    UvBackend& operator=(const UvBackend&) = delete;
+
+    void start_draining() {
+        if (!uv_is_active(reinterpret_cast<uv_handle_t*>(&drain_idle))) {
+            uv_idle_start(&drain_idle, idle_cb);
+        }
+    }
+
+    void stop_draining() {
+        uv_idle_stop(&drain_idle);
+    }
+
+    // Timer handles are reused rather than closed: closing handles run in LIFO order at the end of
+    // the loop iteration, which would resume timers that expire together in reverse
+    void start_timer(Timer& timer, std::chrono::milliseconds delay) {
+        if (free_timers.empty()) {
+            timers.push_back(std::make_unique<uv_timer_t>());
+            uv_timer_init(&loop, timers.back().get());
+            free_timers.push_back(timers.back().get());
+        }
+        timer.handle = free_timers.back();
+        free_timers.pop_back();
+        timer.handle->data = &timer;
+        // libuv times out against the loop's cached millisecond clock, which lags the real one;
+        // add the lag, rounded up, so a timer never fires before its delay has passed
+        const auto lag = (uv_hrtime() + 999'999) / 1'000'000 - uv_now(&loop);
+        int res = uv_timer_start(timer.handle, timer_cb, static_cast<std::uint64_t>(delay.count()) + lag, 0);
+        assert(res == 0);
+    }
+
+    void init_wakeup(Wakeup& wakeup) {
+        uv_async_init(&loop, &wakeup.handle, async_cb);
+        wakeup.handle.data = &wakeup;
+    }
+
+    // Thread-safe; sends before the callback runs are coalesced
+    static void send(Wakeup& wakeup) {
+        uv_async_send(&wakeup.handle);
+    }
+
+    void close_wakeup(Wakeup& wakeup) {
+        uv_close(reinterpret_cast<uv_handle_t*>(&wakeup.handle), nullptr);
+    }
+
+    void submit(IoRequest& request) {
+        request.req.data = &request;
+        auto buf = uv_buf_init(static_cast<char*>(request.buffer), static_cast<unsigned int>(request.length));
+        int res = request.kind == IoKind::Read
+            ? uv_fs_read(&loop, &request.req, request.fd, &buf, 1, request.offset, fs_cb)
+            : uv_fs_write(&loop, &request.req, request.fd, &buf, 1, request.offset, fs_cb);
+        if (res < 0) {
+            request.result = res;
+            request.callback(request);
+        }
+    }
+
+    // Runs on the libuv threadpool (UV_THREADPOOL_SIZE threads)
+    void queue_work(Work& work) {
+        work.req.data = &work;
+        uv_queue_work(&loop, &work.req, work_cb, after_work_cb);
+    }
+
+    void run() {
+        uv_run(&loop, UV_RUN_DEFAULT);
+    }
+
+    uv_loop_t* get_loop() { return &loop; }
+
+private:
+    static void idle_cb(uv_idle_t* handle) {
+        auto* self = static_cast<UvBackend*>(handle->data);
+        self->drain(self->owner);
+    }
+
+    // The handle goes back to the pool before the owner is told, so the owning awaitable may go
+    // away as soon as its coroutine resumes
+    static void timer_cb(uv_timer_t* handle) {
+        auto* self = static_cast<UvBackend*>(handle->loop->data);
+        auto* timer = static_cast<Timer*>(handle->data);
+        timer->handle = nullptr;
+        handle->data = nullptr;
+        self->free_timers.push_back(handle);
+        timer->callback(*timer);
+    }
+
+    static void async_cb(uv_async_t* handle) {
+        auto* wakeup = static_cast<Wakeup*>(handle->data);
+        wakeup->callback(*wakeup);
+    }
+
+    static void fs_cb(uv_fs_t* req) {
+        auto* request = static_cast<IoRequest*>(req->data);
+        request->result = req->result;
+        uv_fs_req_cleanup(req);
+        request->callback(*request);
+    }
+
+    static void work_cb(uv_work_t* req) {
+        auto* work = static_cast<Work*>(req->data);
+        work->work(*work);
+    }
+
+    static void after_work_cb(uv_work_t* req, int) {
+        auto* work = static_cast<Work*>(req->data);
+        work->callback(*work);
+    }
+
+    uv_loop_t loop;
+    uv_idle_t drain_idle;
+    std::vector<std::unique_ptr<uv_timer_t>> timers;
+    std::vector<uv_timer_t*> free_timers;
+    void* owner;
+    void (*drain)(void*);
+};
+
+
+#endif //CATCH2TESTEXAMPLE_UV_BACKEND_HPP
@@ -0,0 +1,238 @@
+//
+// Created by per on 2026-10-18.
+//
+
+#ifndef CATCH2TESTEXAMPLE_WATCHDOG_HPP
+#define CATCH2TESTEXAMPLE_WATCHDOG_HPP
+
+#include "scheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <execinfo.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <uv.h>
+#include <vector>
+
+// A loop iteration step that ran longer than the watchdog threshold
+struct LoopStall {
+    void* coroutine = nullptr;           // frame the loop resumed, nullptr if a libuv callback stalled
+    std::chrono::milliseconds duration{0};  // at detection, updated once the step finishes
+    std::vector<void*> stack;            // loop thread's stack, sampled while it was stalled
+
+    std::vector<std::string> symbols() const {
+        std::vector<std::string> result;
+        if (stack.empty()) {
+            return result;
+        }
+        std::unique_ptr<char*, decltype(&free)> names(
+            backtrace_symbols(stack.data(), static_cast<int>(stack.size())), &free);
+        for (std::size_t i = 0; names && i < stack.size(); ++i) {
+            result.emplace_back(names.get()[i]);
+        }
+        return result;
+    }
+};
+
+struct WatchdogOptions {
+    std::chrono::milliseconds threshold{100};
+    std::chrono::milliseconds poll_interval{0};  // 0 samples four times per threshold
+    bool sample_stacks = true;
+    std::function<void(const LoopStall&)> on_stall{};  // called on the monitor thread
+};
+
+// Flags loop steps that block the loop for longer than a threshold. The loop marks itself idle in
+// uv_prepare, just before it polls, and busy again in uv_check; in between, the scheduler beats
+// once per resumed coroutine (a single relaxed store). A monitor thread samples the heartbeat and
+// reports a value that stays unchanged and non-idle for longer than the threshold, together with
+// a stack sample taken by signalling the loop thread (sample_signal()).
+//
+// Construct it on the loop thread of a libuv Scheduler, and destroy it before the scheduler.
+class LoopWatchdog {
+public:
+    static constexpr std::size_t max_stack_depth = 64;
+
+    explicit LoopWatchdog(UvScheduler& scheduler, WatchdogOptions options = {})
+        : state(new State(scheduler, std::move(options))) {
+        if (state->options.poll_interval.count() == 0) {
+            state->options.poll_interval = std::max(std::chrono::milliseconds(1), state->options.threshold / 4);
+        }
+        if (state->options.sample_stacks) {
+            install_handler();
+        }
+
+        auto* loop = scheduler.get_loop();
+        uv_prepare_init(loop, &state->prepare);
+        uv_check_init(loop, &state->check);
+        state->prepare.data = state;
+        state->check.data = state;
+        uv_prepare_start(&state->prepare, [](uv_prepare_t* handle) {
+            static_cast<State*>(handle->data)->heartbeat.set_idle();
+        });
+        uv_check_start(&state->check, [](uv_check_t* handle) {
+            static_cast<State*>(handle->data)->heartbeat.beat(LoopHeartbeat::callback_tag);
+        });
+        // Watching the loop must not keep it running
+        uv_unref(reinterpret_cast<uv_handle_t*>(&state->prepare));
+        uv_unref(reinterpret_cast<uv_handle_t*>(&state->check));
+
+        state->heartbeat.beat(LoopHeartbeat::callback_tag);
+        scheduler.set_heartbeat(&state->heartbeat);
+        state->monitor = std::thread([s = state] { s->watch(); });
+    }
+
+    ~LoopWatchdog() {
+        {
+            std::lock_guard lock(state->mutex);
+            state->stopping = true;
+        }
+        state->wake.notify_one();
+        state->monitor.join();
+        state->scheduler.set_heartbeat(nullptr);
+
+        // The state is freed once both handles are closed
+        auto close_cb = [](uv_handle_t* handle) {
+            auto* s = static_cast<State*>(handle->data);
+            if (--s->open_handles == 0) {
+                delete s;
+            }
+        };
+        uv_close(reinterpret_cast<uv_handle_t*>(&state->prepare), close_cb);
+        uv_close(reinterpret_cast<uv_handle_t*>(&state->check), close_cb);
+    }
+
+    LoopWatchdog(const LoopWatchdog&) = delete;
+    LoopWatchdog& operator=(const LoopWatchdog&) = delete;
+
+    std::vector<LoopStall> stalls() const {
+        std::lock_guard lock(state->mutex);
+        return state->stalls;
+    }
+
+    // Real-time signal used to sample the loop thread's stack
+    static int sample_signal() { return SIGRTMIN + 5; }
+
+private:
+    struct StackSample {
+        void* frames[max_stack_depth];
+        std::atomic<int> depth{-1};
+    };
+
+    // Sample requested from the monitor thread, filled in by the handler on the loop thread
+    static inline std::atomic<StackSample*> pending_sample{nullptr};
+    static inline std::mutex sample_mutex;
+
+    static void install_handler() {
+        static std::once_flag installed;
+        std::call_once(installed, [] {
+            // The first backtrace() call loads libgcc, which is not safe inside a signal handler
+            void* frames[1];
+            backtrace(frames, 1);
+
+            struct sigaction action{};
+            action.sa_handler = [](int) {
+                if (auto* sample = pending_sample.load(std::memory_order_acquire)) {
+                    sample->depth.store(backtrace(sample->frames, max_stack_depth), std::memory_order_release);
+                }
+            };
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(sample_signal(), &action, nullptr);
+        });
+    }
+
+    struct State {
+        State(UvScheduler& scheduler, WatchdogOptions options)
+            : scheduler(scheduler), options(std::move(options)), loop_thread(pthread_self()) {}
+
+        void watch() {
+            auto last = heartbeat.value.load(std::memory_order_relaxed);
+            auto since = std::chrono::steady_clock::now();
+            bool reported = false;
+
+            std::unique_lock lock(mutex);
+            while (!wake.wait_for(lock, options.poll_interval, [this] { return stopping; })) {
+                const auto now = std::chrono::steady_clock::now();
+                const auto value = heartbeat.value.load(std::memory_order_relaxed);
+                if (value != last) {
+                    if (reported) {
+                        // The stalled step finished; record how long it really took
+                        stalls.back().duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - since);
+                    }
+                    last = value;
+                    since = now;
+                    reported = false;
+                    continue;
+                }
+                if (value == LoopHeartbeat::idle || reported || now - since < options.threshold) {
+                    continue;
+                }
+
+                LoopStall stall;
+                stall.coroutine = LoopHeartbeat::coroutine(value);
+                stall.duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - since);
+                lock.unlock();
+                if (options.sample_stacks) {
+                    stall.stack = sample_stack();
+                }
+                if (options.on_stall) {
+                    options.on_stall(stall);
+                }
+                lock.lock();
+                stalls.push_back(std::move(stall));
+                reported = true;
+            }
+        }
+
+        std::vector<void*> sample_stack() {
+            std::lock_guard sample_lock(sample_mutex);
+            sample.depth.store(-1, std::memory_order_relaxed);
+            pending_sample.store(&sample, std::memory_order_release);
+            pthread_kill(loop_thread, sample_signal());
+
+            std::vector<void*> frames;
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+            while (std::chrono::steady_clock::now() < deadline) {
+                const int depth = sample.depth.load(std::memory_order_acquire);
+                if (depth >= 0) {
+                    frames.assign(sample.frames, sample.frames + depth);
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            // A handler that already picked up the sample only ever writes into this state,
+            // which outlives it: the state is freed on the loop thread the handler runs on
+            pending_sample.store(nullptr, std::memory_order_release);
+            return frames;
+        }
+
+        UvScheduler& scheduler;
+        WatchdogOptions options;
+        pthread_t loop_thread;
+        LoopHeartbeat heartbeat;
+        StackSample sample;
+        uv_prepare_t prepare;
+        uv_check_t check;
+        int open_handles = 2;
+
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+        std::vector<LoopStall> stalls;
+        std::thread monitor;
+    };
+
+    State* state;
+};
+
+
+#endif //CATCH2TESTEXAMPLE_WATCHDOG_HPP